@@ -16,21 +16,56 @@ limitations under the License.
 
 #pragma once
 
+#include <cmath>
 #include <iomanip>
+#include <istream>
 #include <limits>
+#include <locale>
 #include <math.h>
 #include <stdexcept>
 #include <string>
 #include <sstream>
 #include <cstdint>
+#include <cstring>
+#include <functional>
+#include <system_error>
+#include <type_traits>
 
-#include <boost/multiprecision/cpp_int.hpp>
 #include <boost/optional.hpp>
 
+// 128 bit arithmetic uses the compiler's unsigned __int128 where available (gcc/clang on 64 bit targets).
+// Define DECIMAL_USE_BOOST_MULTIPRECISION to force the portable boost::multiprecision fallback.
+#if defined(__SIZEOF_INT128__) && !defined(DECIMAL_USE_BOOST_MULTIPRECISION)
+#define DECIMAL_NATIVE_INT128 1
+#else
+#include <boost/multiprecision/cpp_int.hpp>
+#endif
+
+// Arithmetic is constexpr only on the native backend, boost::multiprecision types are not literal types.
+#ifdef DECIMAL_NATIVE_INT128
+#define DECIMAL_CONSTEXPR constexpr
+#else
+#define DECIMAL_CONSTEXPR inline
+#endif
+
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define DECIMAL_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#endif
+
 #define PREPROCESSOR_STRINGIZE_A(x) #x
 #define PREPROCESSOR_STRINGIZE(x) PREPROCESSOR_STRINGIZE_A(x)
 #define STR__LINE__ PREPROCESSOR_STRINGIZE(__LINE__)
 
+// Define DECIMAL_INSTRUMENTATION to count operations per thread, see DecimalInstrumentation.hpp
+#ifdef DECIMAL_INSTRUMENTATION
+#include "DecimalInstrumentation.hpp"
+#else
+#define DECIMAL_COUNT(counter) ((void)0)
+#define DECIMAL_THROW(exception) throw exception
+#endif
+
 namespace tylawin
 {
 	template<typename T>
@@ -41,116 +76,727 @@ namespace tylawin
 
 	namespace DataTypes
 	{
-		class Decimal
+		// Rounding applied to dropped fraction digits. HalfUp rounds ties away from zero.
+		enum class RoundingMode
 		{
-		private:
-			static const constexpr uint16_t FRACTION_DIGITS = 19;
-			static const constexpr uint64_t fractionDenominator_ = constexpr_pow(10ULL, FRACTION_DIGITS);
-			static const constexpr uint64_t maxValue_ = fractionDenominator_ - 1;
+			Truncate,// toward zero
+			HalfUp,
+			HalfEven,
+			Floor,// toward -infinity
+			Ceiling// toward +infinity
+		};
 
-		public:
-			Decimal() : positive_(true), whole_(0), fraction_(0)
-			{ }
+		struct from_chars_result
+		{
+			const char *ptr;
+			std::errc ec;
+		};
 
-			Decimal(const Decimal &value) : positive_(value.positive_), whole_(value.whole_), fraction_(value.fraction_)
-			{ }
+		struct to_chars_result
+		{
+			char *ptr;
+			std::errc ec;
+		};
+
+		namespace detail
+		{
+#ifdef DECIMAL_NATIVE_INT128
+			__extension__ typedef unsigned __int128 uint128_t;
+			__extension__ typedef __int128 int128_t;
+#else
+			typedef boost::multiprecision::uint128_t uint128_t;
+#endif
+
+			template<typename T>
+			struct UnsignedOf;
+			template<>
+			struct UnsignedOf<int64_t>
+			{
+				typedef uint64_t type;
+			};
+#ifdef DECIMAL_NATIVE_INT128
+			template<>
+			struct UnsignedOf<int128_t>
+			{
+				typedef uint128_t type;
+			};
+#endif
 
-			Decimal(int32_t value)
+			// integer operands of Decimal's mixed operators, widened to int64_t or uint64_t
+			template<typename T>
+			struct IsInteger : std::integral_constant<bool, std::is_integral<T>::value && !std::is_same<T, bool>::value>
+			{ };
+
+			template<typename T>
+			using IntegerOperand = typename std::conditional<std::is_signed<T>::value, int64_t, uint64_t>::type;
+
+			constexpr bool integerNegative(int64_t value)
 			{
-				positive_ = (value >= 0);
-				value = abs(value);
-				whole_ = value;
-				fraction_ = 0;
+				return value < 0;
 			}
 
-			Decimal(const uint32_t value) : positive_(true), whole_(value), fraction_(0)
-			{ }
+			constexpr bool integerNegative(uint64_t)
+			{
+				return false;
+			}
 
-			Decimal(int64_t value)
+			template<typename T>
+			constexpr bool integerNegative(T value)
 			{
-				positive_ = (value >= 0);
-				value = abs(value);
-				whole_ = value;
-				fraction_ = 0;
+				return integerNegative(static_cast<IntegerOperand<T>>(value));
 			}
 
-			Decimal(uint64_t value) : positive_(true), whole_(value), fraction_(0)
-			{ }
+			constexpr uint64_t integerMagnitude(int64_t value)
+			{
+				return value < 0 ? 0 - uint64_t(value) : uint64_t(value);
+			}
+
+			constexpr uint64_t integerMagnitude(uint64_t value)
+			{
+				return value;
+			}
+
+			template<typename T>
+			constexpr uint64_t integerMagnitude(T value)
+			{
+				return integerMagnitude(static_cast<IntegerOperand<T>>(value));
+			}
+
+			// returns the low 64 bits of a * b and stores the high 64 bits in hi
+			DECIMAL_CONSTEXPR uint64_t mul64x64(uint64_t a, uint64_t b, uint64_t &hi)
+			{
+				uint128_t p = static_cast<uint128_t>(a) * b;
+				hi = static_cast<uint64_t>(p >> 64);
+				return static_cast<uint64_t>(p);
+			}
+
+#if defined(DECIMAL_NATIVE_INT128) && defined(__x86_64__) && defined(DECIMAL_HAS_IS_CONSTANT_EVALUATED)
+#define DECIMAL_X86_64_DIVQ 1
+			inline uint64_t div128by64Divq(uint64_t hi, uint64_t lo, uint64_t d, uint64_t &rem)
+			{
+				uint64_t q;
+				__asm__("divq %4" : "=a"(q), "=d"(rem) : "a"(lo), "d"(hi), "rm"(d));
+				return q;
+			}
+#endif
 
-			Decimal(float value)
+			// (hi:lo) / d, requires hi < d so the quotient fits in 64 bits
+			DECIMAL_CONSTEXPR uint64_t div128by64(uint64_t hi, uint64_t lo, uint64_t d, uint64_t &rem)
 			{
-				std::stringstream sigDigits;
-				uint64_t whole = static_cast<uint64_t>(abs(value));
-				uint8_t wholeDigits;
-				for(wholeDigits = 0; whole > 0; ++wholeDigits)
-					whole /= 10;
-				sigDigits << std::fixed << std::setprecision(std::numeric_limits<float>::digits10 - wholeDigits) << value;
-				*this = Decimal(sigDigits.str());
+#ifdef DECIMAL_X86_64_DIVQ
+				if(!__builtin_is_constant_evaluated())
+					return div128by64Divq(hi, lo, d, rem);
+#endif
+				uint128_t n = (static_cast<uint128_t>(hi) << 64) | lo;
+				uint128_t q = n / d;
+				rem = static_cast<uint64_t>(n - q * d);
+				return static_cast<uint64_t>(q);
 			}
 
-			Decimal(double value)
+			// floor((2^128 - 1) / d) - 2^64, d must have its top bit set
+			DECIMAL_CONSTEXPR uint64_t reciprocal(uint64_t d)
 			{
-				std::stringstream sigDigits;
-				uint64_t whole = static_cast<uint64_t>(abs(value));
-				uint8_t wholeDigits;
-				for(wholeDigits = 0; whole > 0; ++wholeDigits)
-					whole /= 10;
-				sigDigits << std::fixed << std::setprecision(std::numeric_limits<double>::digits10 - wholeDigits) << value;
-				*this = Decimal(sigDigits.str());
+				uint64_t rem = 0;
+				return div128by64(~d, ~0ULL, d, rem);
 			}
 
-			Decimal(long double value)
+			// reciprocal() using only 64 bit ops so it is a constant expression on every backend
+			constexpr uint64_t reciprocalConstexpr(uint64_t d)
 			{
-				std::stringstream sigDigits;
-				uint64_t whole = static_cast<uint64_t>(abs(value));
-				uint8_t wholeDigits;
-				for(wholeDigits = 0; whole > 0; ++wholeDigits)
-					whole /= 10;
-				sigDigits << std::fixed << std::setprecision(std::numeric_limits<long double>::digits10 - wholeDigits) << value;
-				*this = Decimal(sigDigits.str());
+				uint64_t q = 0, r = ~d;
+				for(int i = 63; i >= 0; --i)
+				{
+					bool carry = (r >> 63) != 0;
+					r = (r << 1) | 1;
+					if(carry || r >= d)
+					{
+						r -= d;
+						q |= 1ULL << i;
+					}
+				}
+				return q;
+			}
+
+			// (hi:lo) / d using a precomputed reciprocal v of d instead of a hardware divide.
+			// Moller & Granlund, "Improved division by invariant integers", algorithm 4. Requires hi < d and d's top bit set.
+			DECIMAL_CONSTEXPR uint64_t div128by64Preinv(uint64_t hi, uint64_t lo, uint64_t d, uint64_t v, uint64_t &rem)
+			{
+				uint64_t q1 = 0;
+				uint64_t q0 = mul64x64(v, hi, q1);
+				q0 += lo;
+				q1 += hi + (q0 < lo) + 1;
+				uint64_t r = lo - q1 * d;
+				if(r > q0)
+				{
+					--q1;
+					r += d;
+				}
+				if(r >= d)
+				{
+					++q1;
+					r -= d;
+				}
+				rem = r;
+				return q1;
 			}
 
-			Decimal(std::string value)
+			constexpr unsigned countLeadingZeros(uint64_t x)// x != 0
 			{
-				if(value.find_first_not_of("-01234.56789") != std::string::npos)
-					throw std::invalid_argument(__FILE__ ":" STR__LINE__ " - string constructor failed. value(" + value + ")");
-				if(value.size() == 0)
-					value = "0";
+#if defined(__GNUC__)
+				return __builtin_clzll(x);
+#else
+				unsigned n = 0;
+				for(; !(x & (1ULL << 63)); x <<= 1)
+					++n;
+				return n;
+#endif
+			}
 
-				if(value[0] == '-')
+			// (n2:n1:n0) / (dh:dl), requires dh != 0 and (n2:n1) < (dh:dl) so the quotient fits in 64 bits.
+			// Single quotient digit of Knuth's algorithm D.
+			DECIMAL_CONSTEXPR uint64_t div192by128(uint64_t n2, uint64_t n1, uint64_t n0, uint64_t dh, uint64_t dl, uint64_t &remHi, uint64_t &remLo)
+			{
+				unsigned s = countLeadingZeros(dh);
+				if(s)
 				{
-					positive_ = false;
-					value = value.substr(1);
+					dh = dh << s | dl >> (64 - s);
+					dl <<= s;
+					n2 = n2 << s | n1 >> (64 - s);
+					n1 = n1 << s | n0 >> (64 - s);
+					n0 <<= s;
 				}
+
+				uint64_t q = 0, unused = 0;
+				if(n2 >= dh)
+					q = ~0ULL;
 				else
-					positive_ = true;
+					q = div128by64(n2, n1, dh, unused);
 
-				if(value[0] == '.' && value.size() > 1)
-					value = "0" + value;
+				// n - q * d, the estimate is at most 2 too large
+				uint64_t p0Hi = 0, p1Hi = 0;
+				uint64_t p0 = mul64x64(q, dl, p0Hi);
+				uint64_t p1 = mul64x64(q, dh, p1Hi);
+				p1 += p0Hi;
+				p1Hi += (p1 < p0Hi);
 
-				size_t periodPos = value.find('.');
-				if(periodPos == value.npos)
+				uint64_t r0 = n0 - p0;
+				uint64_t borrow = (n0 < p0);
+				uint64_t t = n1 - p1;
+				uint64_t r1 = t - borrow;
+				borrow = (n1 < p1) | (t < borrow);
+				uint64_t r2 = n2 - p1Hi - borrow;
+				while(static_cast<int64_t>(r2) < 0)
 				{
-					whole_ = std::stoull(value);
-					fraction_ = 0;
+					--q;
+					r0 += dl;
+					uint64_t carry = (r0 < dl);
+					t = r1 + carry;
+					carry = (t < carry);
+					r1 = t + dh;
+					carry |= (r1 < dh);
+					r2 += carry;
+				}
+
+				if(s)
+				{
+					r0 = r0 >> s | r1 << (64 - s);
+					r1 >>= s;
+				}
+				remHi = r1;
+				remLo = r0;
+				return q;
+			}
+
+			// reciprocal of the normalized 128 bit divisor (d1:d0) for div192by128Preinv: floor((2^192 - 1) / (d1:d0)) - 2^64.
+			// Moller & Granlund, "Improved division by invariant integers", algorithm 6. Requires d1's top bit set.
+			DECIMAL_CONSTEXPR uint64_t reciprocal(uint64_t d1, uint64_t d0)
+			{
+				uint64_t v = reciprocal(d1);
+				uint64_t p = d1 * v + d0;
+				if(p < d0)
+				{
+					--v;
+					if(p >= d1)
+					{
+						--v;
+						p -= d1;
+					}
+					p -= d1;
+				}
+				uint64_t t1 = 0;
+				uint64_t t0 = mul64x64(d0, v, t1);
+				p += t1;
+				if(p < t1)
+				{
+					--v;
+					if(p > d1 || (p == d1 && t0 >= d0))
+						--v;
+				}
+				return v;
+			}
+
+			// (n2:n1:n0) / (d1:d0) using the reciprocal v from reciprocal(d1, d0), algorithm 5 of the same paper.
+			// Requires d1's top bit set and (n2:n1) < (d1:d0).
+			DECIMAL_CONSTEXPR uint64_t div192by128Preinv(uint64_t n2, uint64_t n1, uint64_t n0, uint64_t d1, uint64_t d0, uint64_t v, uint64_t &remHi, uint64_t &remLo)
+			{
+				uint64_t q = 0;
+				uint64_t q0 = mul64x64(v, n2, q);
+				q0 += n1;
+				q += n2 + (q0 < n1);
+
+				// top two words of n - q * d
+				uint64_t r1 = n1 - d1 * q;
+				uint64_t r0 = n0 - d0;
+				r1 -= d1 + (n0 < d0);
+				uint64_t t1 = 0;
+				uint64_t t0 = mul64x64(d0, q, t1);
+				r1 -= t1 + (r0 < t0);
+				r0 -= t0;
+				++q;
+
+				if(r1 >= q0)
+				{
+					--q;
+					r0 += d0;
+					r1 += d1 + (r0 < d0);
+				}
+				if(r1 > d1 || (r1 == d1 && r0 >= d0))
+				{
+					++q;
+					r1 -= d1 + (r0 < d0);
+					r0 -= d0;
+				}
+				remHi = r1;
+				remLo = r0;
+				return q;
+			}
+
+			const constexpr uint64_t pow10Table[20] = {
+				1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL, 100000000ULL, 1000000000ULL,
+				10000000000ULL, 100000000000ULL, 1000000000000ULL, 10000000000000ULL, 100000000000000ULL,
+				1000000000000000ULL, 10000000000000000ULL, 100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL
+			};
+
+			// reciprocal() of 10^k shifted up until its top bit is set
+			constexpr uint64_t pow10Reciprocal(unsigned k)
+			{
+				return reciprocalConstexpr(pow10Table[k] << countLeadingZeros(pow10Table[k]));
+			}
+
+			const constexpr uint64_t pow10ReciprocalTable[20] = {
+				pow10Reciprocal(0), pow10Reciprocal(1), pow10Reciprocal(2), pow10Reciprocal(3), pow10Reciprocal(4),
+				pow10Reciprocal(5), pow10Reciprocal(6), pow10Reciprocal(7), pow10Reciprocal(8), pow10Reciprocal(9),
+				pow10Reciprocal(10), pow10Reciprocal(11), pow10Reciprocal(12), pow10Reciprocal(13), pow10Reciprocal(14),
+				pow10Reciprocal(15), pow10Reciprocal(16), pow10Reciprocal(17), pow10Reciprocal(18), pow10Reciprocal(19)
+			};
+
+			// 1 if the truncated magnitude quotient q with remainder r of a division by d must be incremented under mode
+			constexpr uint64_t roundingIncrement(uint64_t q, uint64_t r, uint64_t d, bool negative, RoundingMode mode)
+			{
+				if(r == 0)
+					return 0;
+				switch(mode)
+				{
+				case RoundingMode::HalfUp:
+					return r >= d - r;
+				case RoundingMode::HalfEven:
+					return r > d - r || (r == d - r && (q & 1));
+				case RoundingMode::Floor:
+					return negative;
+				case RoundingMode::Ceiling:
+					return !negative;
+				default:
+					return 0;
+				}
+			}
+
+			// magnitude scaled by 10^from rescaled to 10^to, rounding dropped digits by mode. Sets overflow if it exceeds 128 bits.
+			DECIMAL_CONSTEXPR uint128_t rescale(uint128_t mag, uint16_t from, uint16_t to, bool negative, RoundingMode mode, bool &overflow)
+			{
+				if(to >= from)
+				{
+					uint64_t m = pow10Table[to - from];
+					if(mag > ~uint128_t(0) / m)
+						overflow = true;
+					return mag * m;
+				}
+				uint64_t d = pow10Table[from - to];
+				uint64_t hi = static_cast<uint64_t>(mag >> 64), rem = 0;
+				uint64_t qHi = hi / d;
+				uint64_t qLo = div128by64(hi % d, static_cast<uint64_t>(mag), d, rem);
+				return ((static_cast<uint128_t>(qHi) << 64) | qLo) + roundingIncrement(qLo, rem, d, negative, mode);
+			}
+
+			// little endian load of 8 chars, gcc/clang merge this into a single 64 bit load
+			constexpr uint64_t loadEightChars(const char *p)
+			{
+				return uint64_t(uint8_t(p[0])) | uint64_t(uint8_t(p[1])) << 8 | uint64_t(uint8_t(p[2])) << 16 | uint64_t(uint8_t(p[3])) << 24
+					| uint64_t(uint8_t(p[4])) << 32 | uint64_t(uint8_t(p[5])) << 40 | uint64_t(uint8_t(p[6])) << 48 | uint64_t(uint8_t(p[7])) << 56;
+			}
+
+			// true if all 8 bytes are in '0'..'9'
+			constexpr bool isEightDigits(uint64_t val)
+			{
+				return (((val & 0xF0F0F0F0F0F0F0F0ULL) | (((val + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+			}
+
+			// SWAR: converts 8 ascii digits (first char most significant) in 3 multiplies
+			constexpr uint32_t parseEightDigits(uint64_t val)
+			{
+				val = (val & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+				val = (val & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+				return static_cast<uint32_t>((val & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+			}
+
+			constexpr const char* skipDigits(const char *first, const char *last)
+			{
+				while(last - first >= 8 && isEightDigits(loadEightChars(first)))
+					first += 8;
+				while(first != last && *first >= '0' && *first <= '9')
+					++first;
+				return first;
+			}
+
+			// caller guarantees [first, last) is all digits and at most 19 long
+			constexpr uint64_t parseDigits(const char *first, const char *last)
+			{
+				uint64_t res = 0;
+				while(last - first >= 8)
+				{
+					res = res * 100000000ULL + parseEightDigits(loadEightChars(first));
+					first += 8;
+				}
+				while(first != last)
+					res = res * 10 + uint8_t(*first++ - '0');
+				return res;
+			}
+
+			constexpr size_t length(const char *str)
+			{
+				size_t len = 0;
+				while(str[len] != '\0')
+					++len;
+				return len;
+			}
+
+			const constexpr char digitPairs[] =
+				"0001020304050607080910111213141516171819202122232425262728293031323334353637383940414243444546474849"
+				"5051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+			// writes value right aligned so that the last digit is at end[-1], returns first digit
+			inline char* writeDigitsBackward(char *end, uint64_t value)
+			{
+				while(value >= 100)
+				{
+					const char *pair = digitPairs + (value % 100) * 2;
+					value /= 100;
+					*--end = pair[1];
+					*--end = pair[0];
+				}
+				if(value >= 10)
+				{
+					*--end = digitPairs[value * 2 + 1];
+					*--end = digitPairs[value * 2];
+				}
+				else
+					*--end = char('0' + value);
+				return end;
+			}
+
+			// writes exactly 19 digits including leading zeros
+			inline void writeNineteenDigits(char *out, uint64_t value)
+			{
+				char *end = out + 19;
+				for(int i = 0; i < 9; ++i)
+				{
+					const char *pair = digitPairs + (value % 100) * 2;
+					value /= 100;
+					*--end = pair[1];
+					*--end = pair[0];
+				}
+				*--end = char('0' + value);
+			}
+
+			// value == mantissa * 2^exponent for finite value > 0, keeping at most 64 significant bits
+			template<typename Float>
+			inline uint64_t binaryMantissa(Float value, int &exponent)
+			{
+				const int bits = std::numeric_limits<Float>::digits < 64 ? std::numeric_limits<Float>::digits : 64;
+				int e = 0;
+				Float f = std::frexp(value, &e);
+				exponent = e - bits;
+				return static_cast<uint64_t>(std::ldexp(f, bits));
+			}
+
+			// mantissa * 2^exponent * 10^digits rounded half to even, sets overflow when that is >= 2^64
+			inline uint64_t scaleBinary(uint64_t mantissa, int exponent, uint8_t digits, bool &overflow)
+			{
+				uint64_t hi = 0;
+				uint64_t lo = mul64x64(mantissa, pow10Table[digits], hi);
+				if(exponent >= 0)
+				{
+					if(hi != 0 || exponent >= 64 || (exponent > 0 && (lo >> (64 - exponent)) != 0))
+						overflow = true;
+					return exponent < 64 ? lo << exponent : 0;
+				}
+				unsigned shift = unsigned(-exponent);
+				if(shift > 128)
+					return 0;
+				uint64_t q = 0;
+				if(shift < 64)
+				{
+					if(hi >> shift)
+						overflow = true;
+					q = (lo >> shift) | (hi << (64 - shift));
+				}
+				else if(shift < 128)
+					q = hi >> (shift - 64);
+				// the highest bit shifted out decides, ties go to the even quotient
+				unsigned k = shift - 1;
+				bool half = k < 64 ? (lo >> k) & 1 : (hi >> (k - 64)) & 1;
+				bool below = k < 64 ? (lo & ((1ULL << k) - 1)) != 0 : (lo != 0 || (hi & ((1ULL << (k - 64)) - 1)) != 0);
+				if(half && (below || (q & 1)))
+				{
+					if(++q == 0)
+						overflow = true;
+				}
+				return q;
+			}
+
+			// (hi:lo) / 10^19 correctly rounded to nearest even for float, double and 64 bit mantissa long double
+			template<typename Float>
+			inline Float toBinary(bool negative, uint64_t hi, uint64_t lo)
+			{
+				if(hi == 0 && lo == 0)
+					return Float(0);
+				const uint64_t denominator = pow10Table[19];
+				// left align the magnitude in a 192 bit numerator so the quotient has at least 128 significant bits
+				unsigned lz = hi ? countLeadingZeros(hi) : 64 + countLeadingZeros(lo);
+				uint64_t n2 = lz >= 64 ? lo << (lz - 64) : (hi << lz) | (lz ? lo >> (64 - lz) : 0);
+				uint64_t n1 = lz >= 64 ? 0 : lo << lz;
+				uint64_t rem = 0;
+				uint64_t q2 = div128by64(0, n2, denominator, rem);
+				uint64_t q1 = div128by64(rem, n1, denominator, rem);
+				uint64_t q0 = div128by64(rem, 0, denominator, rem);
+
+				// top 64 quotient bits, the next bit and whether anything below it is set
+				uint64_t top, next, below;
+				int exponent = -int(64 + lz);
+				if(q2)
+				{
+					top = (q2 << 63) | (q1 >> 1);
+					next = q1 & 1;
+					below = q0 | rem;
+					exponent += 65;
+				}
+				else
+				{
+					top = q1;
+					next = q0 >> 63;
+					below = (q0 << 1) | rem;
+					exponent += 64;
+				}
+
+				Float res;
+				if(std::numeric_limits<Float>::digits < 64)
+				{
+					// the sticky bit sits well below the rounding position, so the integer conversion rounds correctly
+					res = Float(top | (next | below ? 1 : 0));
 				}
 				else
 				{
-					whole_ = std::stoull(value.substr(0, periodPos));
-					std::string tmp = value.substr(periodPos + 1);
-					if(tmp.size() > FRACTION_DIGITS)
-						tmp = tmp.substr(0, FRACTION_DIGITS);
-					while(tmp.size() < FRACTION_DIGITS)
-						tmp += '0';
-					fraction_ = std::stoull(tmp);
+					if(next && (below || (top & 1)))
+					{
+						if(++top == 0)
+						{
+							top = 1ULL << 63;
+							++exponent;
+						}
+					}
+					res = Float(top);
 				}
+				res = std::ldexp(res, exponent);
+				return negative ? -res : res;
+			}
+		}
+
+		// Storage tag selecting Decimal's original layout: a sign flag plus uint64_t whole and fraction parts (24 bytes)
+		struct SignMagnitude
+		{ };
+
+		template<uint16_t FractionDigits, typename StorageT>
+		class BasicDecimal;
+
+		typedef BasicDecimal<19, SignMagnitude> Decimal;
+
+		template<typename Derived>
+		class DecimalExpression;
+
+		class DecimalColumn;
+		class DecimalAccumulator;
+		class DecimalDotAccumulator;
+		class DecimalDivisor;
+		class DecimalQuantizer;
+		class DecimalPackedColumn;
+
+		namespace detail
+		{
+			struct BinaryCodec;
+			struct CheckedArithmetic;
+			struct ExpressionAccess;
+			struct DecimalHash;
+			struct SortAccess;
+			struct StreamExtraction;
+
+			// Decimal's constants. Being members of a class template lets their definitions below stay in the header
+			// when it is included from several translation units.
+			template<typename = void>
+			class DecimalConstants
+			{
+			public:
+				static const constexpr uint16_t FRACTION_DIGITS = 19;
+
+				// longest output of to_chars without precision: sign, 20 whole digits, '.', 19 fraction digits
+				static const constexpr size_t MAX_STRING_LENGTH = 1 + 20 + 1 + FRACTION_DIGITS;
+
+			protected:
+				static const constexpr uint64_t fractionDenominator_ = constexpr_pow(10ULL, FRACTION_DIGITS);
+				static const constexpr uint64_t maxValue_ = fractionDenominator_ - 1;
+				static const constexpr uint64_t fractionReciprocal_ = reciprocalConstexpr(fractionDenominator_);
+			};
+
+			template<typename T>
+			const constexpr uint16_t DecimalConstants<T>::FRACTION_DIGITS;
+			template<typename T>
+			const constexpr size_t DecimalConstants<T>::MAX_STRING_LENGTH;
+			template<typename T>
+			const constexpr uint64_t DecimalConstants<T>::fractionDenominator_;
+			template<typename T>
+			const constexpr uint64_t DecimalConstants<T>::maxValue_;
+			template<typename T>
+			const constexpr uint64_t DecimalConstants<T>::fractionReciprocal_;
+		}
+
+		to_chars_result to_chars(char *first, char *last, const Decimal &value);
+		to_chars_result to_chars(char *first, char *last, const Decimal &value, size_t precision);
+		double to_double(const Decimal &value);
+		float to_float(const Decimal &value);
+
+		template<>
+		class BasicDecimal<19, SignMagnitude> : public detail::DecimalConstants<>
+		{
+		public:
+			constexpr BasicDecimal() : positive_(true), whole_(0), fraction_(0)
+			{ }
+
+			constexpr BasicDecimal(const Decimal &value) : positive_(value.positive_), whole_(value.whole_), fraction_(value.fraction_)
+			{ }
+
+			constexpr BasicDecimal(int32_t value) : positive_(value >= 0), whole_(value >= 0 ? uint64_t(value) : 0 - uint64_t(value)), fraction_(0)
+			{ }
+
+			constexpr BasicDecimal(const uint32_t value) : positive_(true), whole_(value), fraction_(0)
+			{ }
+
+			constexpr BasicDecimal(int64_t value) : positive_(value >= 0), whole_(value >= 0 ? uint64_t(value) : 0 - uint64_t(value)), fraction_(0)
+			{ }
+
+			constexpr BasicDecimal(uint64_t value) : positive_(true), whole_(value), fraction_(0)
+			{ }
+
+			// Binary floating point values are rounded (half to even on the exact binary value) to
+			// numeric_limits<>::digits10 significant digits but at least to a whole number. Past that the value is kept exactly.
+			// Throws std::invalid_argument for nan/inf and std::out_of_range when the magnitude is 2^64 or more.
+			BasicDecimal(float value) : BasicDecimal(fromBinary(value))
+			{ }
+
+			BasicDecimal(double value) : BasicDecimal(fromBinary(value))
+			{ }
+
+			BasicDecimal(long double value) : BasicDecimal(fromBinary(value))
+			{ }
+
+			// Converts from the fixed width instantiations, always exact. mode only exists for decimal_cast.
+			template<uint16_t FD, typename S>
+			explicit DECIMAL_CONSTEXPR BasicDecimal(const BasicDecimal<FD, S> &value, RoundingMode mode = RoundingMode::Truncate) : positive_(true), whole_(0), fraction_(0)
+			{
+				bool overflow = false;
+				*this = fromSignMagnitude(value.negative(), detail::rescale(value.magnitude(), FD, FRACTION_DIGITS, value.negative(), mode, overflow));
+			}
+
+			BasicDecimal(const std::string &value)
+			{
+				parse(value.data(), value.data() + value.size());
+			}
+			constexpr BasicDecimal(const char value[]) : positive_(true), whole_(0), fraction_(0)
+			{
+				parse(value, value + detail::length(value));
 			}
-			Decimal(const char value[])
+
+			// Parses [-]digits[.digits] from the front of [first, last) like std::from_chars.
+			// Fraction digits past FRACTION_DIGITS are consumed and truncated.
+			// On error value is left unmodified; ec is invalid_argument or result_out_of_range(whole part > uint64_t).
+			static constexpr from_chars_result from_chars(const char *first, const char *last, Decimal &value)
 			{
-				*this = Decimal(std::string(value));
+				DECIMAL_COUNT(Parse);
+				from_chars_result res = {first, std::errc()};
+				const char *p = first;
+				bool positive = true;
+				if(p != last && *p == '-')
+				{
+					positive = false;
+					++p;
+				}
+
+				const char *wholeBegin = p;
+				while(p != last && *p == '0')
+					++p;
+				const char *wholeSigBegin = p;
+				p = detail::skipDigits(p, last);
+				const char *wholeEnd = p;
+
+				const char *fracBegin = p, *fracEnd = p;
+				if(p != last && *p == '.')
+				{
+					fracBegin = p + 1;
+					fracEnd = detail::skipDigits(fracBegin, last);
+				}
+				if(wholeEnd == wholeBegin && fracEnd == fracBegin)
+				{
+					res.ec = std::errc::invalid_argument;
+					return res;
+				}
+				res.ptr = fracEnd;
+
+				uint64_t whole = 0;
+				size_t wholeDigits = wholeEnd - wholeSigBegin;
+				if(wholeDigits < 20)
+					whole = detail::parseDigits(wholeSigBegin, wholeEnd);
+				else
+				{
+					const uint64_t maxDiv10 = std::numeric_limits<uint64_t>::max() / 10;
+					whole = detail::parseDigits(wholeSigBegin, wholeSigBegin + 19);
+					uint8_t lastDigit = uint8_t(wholeSigBegin[19] - '0');
+					if(wholeDigits > 20 || whole > maxDiv10 || (whole == maxDiv10 && lastDigit > std::numeric_limits<uint64_t>::max() % 10))
+					{
+						res.ec = std::errc::result_out_of_range;
+						return res;
+					}
+					whole = whole * 10 + lastDigit;
+				}
+
+				size_t fracDigits = fracEnd - fracBegin;
+				if(fracDigits > FRACTION_DIGITS)
+					fracDigits = FRACTION_DIGITS;
+				uint64_t fraction = detail::parseDigits(fracBegin, fracBegin + fracDigits) * detail::pow10Table[FRACTION_DIGITS - fracDigits];
+
+				value.positive_ = positive || (whole == 0 && fraction == 0);
+				value.whole_ = whole;
+				value.fraction_ = fraction;
+				return res;
 			}
 
-			const Decimal& operator=(const Decimal &rhs)
+			constexpr const Decimal& operator=(const Decimal &rhs)
 			{
 				positive_ = rhs.positive_;
 				whole_ = rhs.whole_;
@@ -160,103 +806,80 @@ namespace tylawin
 
 			const Decimal& operator=(long double value)
 			{
-				if(value >= 0)
-					positive_ = true;
-				else
-					positive_ = false;
-				value = abs(value);
-				whole_ = static_cast<uint64_t>(value);
-				fraction_ = static_cast<uint64_t>((value - whole_)*fractionDenominator_);
-				return *this;
+				return *this = fromBinary(value);
 			}
 
-			bool operator==(const Decimal &rhs) const
+			constexpr bool operator==(const Decimal &rhs) const
 			{
-				if(positive_ == rhs.positive_ && whole_ == rhs.whole_ && fraction_ == rhs.fraction_)
-					return true;
-				else
-					return false;
+				DECIMAL_COUNT(Compare);
+				return (positive_ == rhs.positive_) & (whole_ == rhs.whole_) & (fraction_ == rhs.fraction_);
 			}
 
-			bool operator!=(const Decimal &rhs) const
+			constexpr bool operator!=(const Decimal &rhs) const
 			{
 				return !(*this == rhs);
 			}
 
-			bool operator>(const Decimal &rhs) const
+			constexpr bool operator>(const Decimal &rhs) const
 			{
-				if(positive_ && !rhs.positive_)
-					return true;
-				else if(!positive_ && rhs.positive_)
-					return false;
-				else if(positive_ && rhs.positive_)
-				{
-					if(whole_ == rhs.whole_)
-						return fraction_ > rhs.fraction_;
-					return whole_ > rhs.whole_;
-				}
-				else// if(!positive_ && !rhs.positive_)
-				{
-					if(whole_ == rhs.whole_)
-						return fraction_ < rhs.fraction_;
-					return whole_ < rhs.whole_;
-				}
+				return less(rhs, *this);
 			}
 
-			bool operator>=(const Decimal &rhs) const
+			constexpr bool operator>=(const Decimal &rhs) const
 			{
-				if(*this == rhs)
-					return true;
-				return *this > rhs;
+				return !less(*this, rhs);
 			}
 
-			bool operator<(const Decimal &rhs) const
+			constexpr bool operator<(const Decimal &rhs) const
 			{
-				return !(*this >= rhs);
+				return less(*this, rhs);
 			}
 
-			bool operator<=(const Decimal &rhs) const
+			constexpr bool operator<=(const Decimal &rhs) const
 			{
-				if(*this == rhs)
-					return true;
-				return *this < rhs;
+				return !less(rhs, *this);
 			}
 
-			Decimal operator+(const Decimal &rhs) const
+#ifndef DECIMAL_EXPRESSION_TEMPLATES
+			constexpr Decimal operator+(const Decimal &rhs) const
 			{
 				Decimal tmp(*this);
 				tmp += rhs;
 				return tmp;
 			}
+#endif
 
-			Decimal operator+=(const Decimal &rhs)
+			constexpr Decimal operator+=(const Decimal &rhs)
 			{
+				DECIMAL_COUNT(Add);
 				if(positive_ && rhs.positive_)
 				{
 					whole_ += rhs.whole_;
-					fraction_ += rhs.fraction_;
-					while(fraction_ > maxValue_)
-					{
-						whole_ += 1;
-						fraction_ -= fractionDenominator_;
-					}
+					whole_ += addFraction(fraction_, rhs.fraction_);
 				}
 				else if(positive_ && !rhs.positive_)
 				{
-					*this = *this - (-rhs);
+					DECIMAL_COUNT(AddSubtractSlowPath);
+					*this -= -rhs;
 				}
 				else if(!positive_ && rhs.positive_)
 				{
-					*this = rhs - (-*this);
+					DECIMAL_COUNT(AddSubtractSlowPath);
+					Decimal tmp(rhs);
+					tmp -= -*this;
+					*this = tmp;
 				}
 				else// if(! && !)
 				{
-					*this = -((-*this) + (-rhs));
+					DECIMAL_COUNT(AddSubtractSlowPath);
+					*this = -*this;
+					*this += -rhs;
+					*this = -*this;
 				}
 				return *this;
 			}
 
-			Decimal operator-() const
+			constexpr Decimal operator-() const
 			{
 				Decimal tmp(*this);
 				if(whole_ == 0 && fraction_ == 0)
@@ -266,20 +889,29 @@ namespace tylawin
 				return tmp;
 			}
 
-			Decimal operator-(const Decimal &rhs) const
+#ifndef DECIMAL_EXPRESSION_TEMPLATES
+			constexpr Decimal operator-(const Decimal &rhs) const
 			{
 				Decimal tmp(*this);
 				tmp -= rhs;
 				return tmp;
 			}
+#endif
 
-			Decimal operator-=(const Decimal &rhs)
+			constexpr Decimal operator-=(const Decimal &rhs)
 			{
+				DECIMAL_COUNT(Subtract);
 				if(!rhs.positive_)
-					*this = *this + -(rhs);
+				{
+					DECIMAL_COUNT(AddSubtractSlowPath);
+					*this += -rhs;
+				}
 				else if(!positive_ && rhs.positive_ || whole_ < rhs.whole_ || (whole_ == rhs.whole_ && fraction_ < rhs.fraction_))
 				{
-					*this = -(rhs - *this);
+					DECIMAL_COUNT(AddSubtractSlowPath);
+					Decimal tmp(rhs);
+					tmp -= *this;
+					*this = -tmp;
 				}
 				else// if(positive_ && !rhs.positive_ || whole_ >= rhs.whole_)
 				{
@@ -296,210 +928,1366 @@ namespace tylawin
 				return *this;
 			}
 
-			Decimal operator*(const Decimal &rhs) const
+#ifndef DECIMAL_EXPRESSION_TEMPLATES
+			DECIMAL_CONSTEXPR Decimal operator*(const Decimal &rhs) const
 			{
-				Decimal ret(*this);
-				if(positive_ && rhs.positive_ || !positive_ && !rhs.positive_)
-					ret.positive_ = true;
-				else
-					ret.positive_ = false;
-				ret.whole_ *= rhs.whole_;
-
-				using namespace boost::multiprecision;
-
-				uint128_t frac = static_cast<uint128_t>(ret.fraction_) * rhs.fraction_;
-				frac /= static_cast<uint64_t>(fractionDenominator_);
-
-				uint128_t leftWholeRightFraction = static_cast<uint128_t>(whole_) * rhs.fraction_;
-				uint64_t tmp;
-				tmp = static_cast<uint64_t>(leftWholeRightFraction / fractionDenominator_);
-				ret.whole_ += tmp;
-				frac += static_cast<uint64_t>(leftWholeRightFraction - static_cast<uint128_t>(tmp) * fractionDenominator_);
-				uint128_t rightWholeLeftFraction = static_cast<uint128_t>(rhs.whole_) * fraction_;
-				tmp = static_cast<uint64_t>(rightWholeLeftFraction / fractionDenominator_);
-				ret.whole_ += tmp;
-				frac += static_cast<uint64_t>(rightWholeLeftFraction - static_cast<uint128_t>(tmp) * fractionDenominator_);
-
-				tmp = static_cast<uint64_t>(frac / fractionDenominator_);
-				ret.whole_ += tmp;
-				ret.fraction_ = static_cast<uint64_t>(frac - static_cast<uint128_t>(tmp) * fractionDenominator_);
-				if(ret.whole_ == 0 && ret.fraction_ == 0)//fix edge case "-0"
-					ret.positive_ = true;
-				return ret;
+				Decimal tmp(*this);
+				tmp *= rhs;
+				return tmp;
 			}
+#endif
 
-			Decimal operator*=(const Decimal &rhs)
+			DECIMAL_CONSTEXPR Decimal operator*=(const Decimal &rhs)
 			{
-				*this = *this * rhs;
+				DECIMAL_COUNT(Multiply);
+				Decimal ret;
+				ret.whole_ = whole_ * rhs.whole_;
+
+				uint64_t hi = 0, lo = 0, rem = 0;
+				lo = detail::mul64x64(fraction_, rhs.fraction_, hi);
+				uint64_t frac = divideByDenominator(hi, lo, rem);//truncate
+
+				lo = detail::mul64x64(whole_, rhs.fraction_, hi);
+				ret.whole_ += divideByDenominator(hi, lo, rem);
+				ret.whole_ += addFraction(frac, rem);
+
+				lo = detail::mul64x64(rhs.whole_, fraction_, hi);
+				ret.whole_ += divideByDenominator(hi, lo, rem);
+				ret.whole_ += addFraction(frac, rem);
+
+				ret.fraction_ = frac;
+				ret.positive_ = positive_ == rhs.positive_ || (ret.whole_ == 0 && ret.fraction_ == 0);//fix edge case "-0"
+				*this = ret;
 				return *this;
 			}
 
-			Decimal operator/(const uint64_t rhs) const
+			// divides by the integer directly, also with DECIMAL_EXPRESSION_TEMPLATES
+			DECIMAL_CONSTEXPR Decimal operator/(const uint64_t rhs) const
+			{
+				DECIMAL_COUNT(Divide);
+				Decimal tmp(*this);
+				tmp.divideInteger(false, rhs);
+				return tmp;
+			}
+
+#ifndef DECIMAL_EXPRESSION_TEMPLATES
+			DECIMAL_CONSTEXPR Decimal operator/(const Decimal &rhs) const
 			{
-				return *this / Decimal(rhs);
+				Decimal tmp(*this);
+				tmp /= rhs;
+				return tmp;
 			}
+#endif
 
-			Decimal operator/(const Decimal &rhs) const
+			DECIMAL_CONSTEXPR Decimal operator/=(const Decimal &rhs)
 			{
-				Decimal ret(*this);
+				DECIMAL_COUNT(Divide);
 				if(rhs.whole_ == 0 && rhs.fraction_ == 0)
-					throw std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero");
-				if(positive_ && rhs.positive_ || !positive_ && !rhs.positive_)
-					ret.positive_ = true;
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero"));
+
+				Decimal ret;
+				uint64_t numHi = 0, denHi = 0, rem = 0;
+				uint64_t numLo = scaled(numHi);
+				uint64_t denLo = rhs.scaled(denHi);
+				if(denHi == 0)
+				{
+					rem = numHi % denLo;
+					ret.whole_ = detail::div128by64(rem, numLo, denLo, rem);
+					uint64_t hi = 0, lo = detail::mul64x64(rem, fractionDenominator_, hi);
+					ret.fraction_ = detail::div128by64(hi, lo, denLo, rem);//truncate
+				}
 				else
-					ret.positive_ = false;
-
-				using namespace boost::multiprecision;
-				uint128_t numerator = static_cast<uint128_t>(whole_) * fractionDenominator_ + fraction_;
-				uint128_t denominator = static_cast<uint128_t>(rhs.whole_) * fractionDenominator_ + rhs.fraction_;
-				uint128_t quot, rem;
-				divide_qr(numerator, denominator, quot, rem);
-				ret.whole_ = static_cast<uint64_t>(quot);
-				ret.fraction_ = static_cast<uint64_t>(rem * static_cast<uint256_t>(fractionDenominator_) / denominator);//truncate
-				return ret;
+				{
+					DECIMAL_COUNT(WideDivide);
+					uint64_t remHi = 0, remLo = 0, carry = 0, hi = 0, mid = 0, lo = 0;
+					ret.whole_ = detail::div192by128(0, numHi, numLo, denHi, denLo, remHi, remLo);
+					lo = detail::mul64x64(remLo, fractionDenominator_, carry);
+					mid = detail::mul64x64(remHi, fractionDenominator_, hi);
+					mid += carry;
+					hi += (mid < carry);
+					ret.fraction_ = detail::div192by128(hi, mid, lo, denHi, denLo, remHi, remLo);//truncate
+				}
+				ret.positive_ = positive_ == rhs.positive_ || (ret.whole_ == 0 && ret.fraction_ == 0);
+				*this = ret;
+				return *this;
 			}
 
-			Decimal operator/=(uint64_t rhs)
+			// Mixed integer operators work on the integer's sign and magnitude instead of converting it to a Decimal.
+			// Results match the Decimal operators, including whole part wrap around and truncation.
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr bool operator==(Int rhs) const
 			{
-				*this = *this / rhs;
-				return *this;
+				DECIMAL_COUNT(Compare);
+				return equalsInteger(detail::integerNegative(rhs), detail::integerMagnitude(rhs));
 			}
 
-			Decimal operator/=(const Decimal &rhs)
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr bool operator!=(Int rhs) const
 			{
-				*this = *this / rhs;
-				return *this;
+				return !(*this == rhs);
 			}
 
-			friend std::ostream& operator<<(std::ostream& os, const Decimal &rhs)
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr bool operator<(Int rhs) const
 			{
-				if(!rhs.positive_)
-					os << '-';
-				os << rhs.whole_;
-				if(rhs.fraction_ > 0)
-					os << '.' << rhs.fractionAsString();
-				return os;
+				DECIMAL_COUNT(Compare);
+				return lessThanInteger(detail::integerNegative(rhs), detail::integerMagnitude(rhs));
 			}
-			friend std::istream& operator >> (std::istream& is, Decimal &rhs)
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr bool operator>(Int rhs) const
 			{
-				char ch;
-				if(is.peek() == '-')
-				{
-					rhs.positive_ = false;
-					is >> ch;
-				}
+				DECIMAL_COUNT(Compare);
+				return greaterThanInteger(detail::integerNegative(rhs), detail::integerMagnitude(rhs));
+			}
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr bool operator<=(Int rhs) const
+			{
+				return !(*this > rhs);
+			}
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr bool operator>=(Int rhs) const
+			{
+				return !(*this < rhs);
+			}
+
+#ifndef DECIMAL_EXPRESSION_TEMPLATES
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr Decimal operator+(Int rhs) const
+			{
+				Decimal tmp(*this);
+				tmp += rhs;
+				return tmp;
+			}
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr Decimal operator-(Int rhs) const
+			{
+				Decimal tmp(*this);
+				tmp -= rhs;
+				return tmp;
+			}
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			DECIMAL_CONSTEXPR Decimal operator*(Int rhs) const
+			{
+				Decimal tmp(*this);
+				tmp *= rhs;
+				return tmp;
+			}
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			DECIMAL_CONSTEXPR Decimal operator/(Int rhs) const
+			{
+				Decimal tmp(*this);
+				tmp /= rhs;
+				return tmp;
+			}
+#endif
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr Decimal operator+=(Int rhs)
+			{
+				DECIMAL_COUNT(Add);
+				addInteger(detail::integerNegative(rhs), detail::integerMagnitude(rhs));
+				return *this;
+			}
+
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			constexpr Decimal operator-=(Int rhs)
+			{
+				DECIMAL_COUNT(Subtract);
+				const uint64_t magnitude = detail::integerMagnitude(rhs);
+				addInteger(!detail::integerNegative(rhs) && magnitude != 0, magnitude);
+				return *this;
+			}
+
+			// one 64x64 bit multiply of the fraction, the whole part wraps like operator*=
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			DECIMAL_CONSTEXPR Decimal operator*=(Int rhs)
+			{
+				DECIMAL_COUNT(Multiply);
+				multiplyInteger(detail::integerNegative(rhs), detail::integerMagnitude(rhs));
+				return *this;
+			}
+
+			// Throws std::runtime_error on division by zero.
+			template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+			DECIMAL_CONSTEXPR Decimal operator/=(Int rhs)
+			{
+				DECIMAL_COUNT(Divide);
+				divideInteger(detail::integerNegative(rhs), detail::integerMagnitude(rhs));
+				return *this;
+			}
+
+			template<uint16_t, typename> friend class BasicDecimal;
+			friend class DecimalColumn;
+			friend class DecimalAccumulator;
+			friend class DecimalDotAccumulator;
+			friend class DecimalDivisor;
+			friend class DecimalQuantizer;
+			friend class DecimalPackedColumn;
+			friend struct detail::BinaryCodec;
+			friend struct detail::CheckedArithmetic;
+			friend struct detail::ExpressionAccess;
+			friend struct detail::DecimalHash;
+			friend struct detail::SortAccess;
+			friend struct detail::StreamExtraction;
+			friend to_chars_result to_chars(char *first, char *last, const Decimal &value);
+			friend to_chars_result to_chars(char *first, char *last, const Decimal &value, size_t precision);
+			friend double to_double(const Decimal &value);
+			friend float to_float(const Decimal &value);
+
+			friend std::ostream& operator<<(std::ostream& os, const Decimal &rhs)
+			{
+				DECIMAL_COUNT(StreamOut);
+				char buf[MAX_STRING_LENGTH + 1];
+				*to_chars(buf, buf + MAX_STRING_LENGTH, rhs).ptr = '\0';
+				return os << buf;
+			}
+			friend std::istream& operator >> (std::istream& is, Decimal &rhs);
+
+			// correctly rounded, see to_double
+			long double asDouble() const
+			{
+				DECIMAL_COUNT(ToBinary);
+				uint64_t hi = 0, lo = scaled(hi);
+				return detail::toBinary<long double>(negative(), hi, lo);
+			}
+
+		private:
+			constexpr bool negative() const
+			{
+				return !positive_;
+			}
+
+			// Orders (sign, whole, fraction) lexicographically with whole and fraction complemented for negative values,
+			// so one pass of bitwise ops on the flags instead of branching on the signs. -0 sorts just below 0.
+			static constexpr bool less(const Decimal &a, const Decimal &b)
+			{
+				DECIMAL_COUNT(Compare);
+				const uint64_t aMask = a.positive_ ? 0 : ~0ULL;
+				const uint64_t bMask = b.positive_ ? 0 : ~0ULL;
+				const uint64_t aWhole = a.whole_ ^ aMask, bWhole = b.whole_ ^ bMask;
+				return (a.positive_ < b.positive_) | ((a.positive_ == b.positive_) & ((aWhole < bWhole) | ((aWhole == bWhole) & ((a.fraction_ ^ aMask) < (b.fraction_ ^ bMask)))));
+			}
+
+			constexpr bool equalsInteger(bool negative, uint64_t magnitude) const
+			{
+				return (positive_ != negative) & (whole_ == magnitude) & (fraction_ == 0);
+			}
+
+			// a fraction only matters when the whole parts are equal, where it moves the magnitude above the integer's
+			constexpr bool lessThanInteger(bool negative, uint64_t magnitude) const
+			{
+				if(positive_ == negative)
+					return !positive_;
+				return positive_ ? whole_ < magnitude : (whole_ > magnitude || (whole_ == magnitude && fraction_ != 0));
+			}
+
+			constexpr bool greaterThanInteger(bool negative, uint64_t magnitude) const
+			{
+				if(positive_ == negative)
+					return positive_;
+				return positive_ ? (whole_ > magnitude || (whole_ == magnitude && fraction_ != 0)) : whole_ < magnitude;
+			}
+
+			// *this += (negative ? -magnitude : magnitude), magnitude != 0 when negative
+			constexpr void addInteger(bool negative, uint64_t magnitude)
+			{
+				if(positive_ != negative)
+					whole_ += magnitude;// may wrap around to zero
+				else if(whole_ >= magnitude)
+					whole_ -= magnitude;
 				else
-					rhs.positive_ = true;
+				{
+					// the integer's sign wins, |result| = magnitude - (whole_ + fraction_)
+					whole_ = magnitude - whole_ - (fraction_ != 0);
+					fraction_ = fraction_ != 0 ? fractionDenominator_ - fraction_ : 0;
+					positive_ = !negative;
+				}
+				positive_ = positive_ || (whole_ == 0 && fraction_ == 0);
+			}
+
+			DECIMAL_CONSTEXPR void multiplyInteger(bool negative, uint64_t magnitude)
+			{
+				uint64_t hi = 0, rem = 0, lo = detail::mul64x64(fraction_, magnitude, hi);
+				whole_ = whole_ * magnitude + divideByDenominator(hi, lo, rem);
+				fraction_ = rem;
+				positive_ = positive_ != negative || (whole_ == 0 && fraction_ == 0);
+			}
+
+			// whole_ / magnitude, then the remainder and fraction_ as one 128 bit division
+			DECIMAL_CONSTEXPR void divideInteger(bool negative, uint64_t magnitude)
+			{
+				if(magnitude == 0)
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero"));
+				const uint64_t rem = whole_ % magnitude;
+				whole_ /= magnitude;
+				uint64_t hi = 0, lo = detail::mul64x64(rem, fractionDenominator_, hi);
+				lo += fraction_;
+				hi += (lo < fraction_);
+				uint64_t unused = 0;
+				fraction_ = detail::div128by64(hi, lo, magnitude, unused);//truncate
+				positive_ = positive_ != negative || (whole_ == 0 && fraction_ == 0);
+			}
 
-				bool missingWhole = false;
-				if(is.peek() == '.')
+			// whole_ * fractionDenominator_ + fraction_, the common form for conversions between instantiations
+			DECIMAL_CONSTEXPR detail::uint128_t magnitude() const
+			{
+				uint64_t hi = 0, lo = scaled(hi);
+				return (static_cast<detail::uint128_t>(hi) << 64) | lo;
+			}
+
+			static DECIMAL_CONSTEXPR Decimal fromSignMagnitude(bool negative, detail::uint128_t mag)
+			{
+				uint64_t hi = static_cast<uint64_t>(mag >> 64);
+				if(hi >= fractionDenominator_)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				Decimal ret;
+				ret.whole_ = divideByDenominator(hi, static_cast<uint64_t>(mag), ret.fraction_);
+				ret.positive_ = !negative || (ret.whole_ == 0 && ret.fraction_ == 0);
+				return ret;
+			}
+
+			// whole_ * fractionDenominator_ + fraction_ as a 128 bit magnitude, returns the low 64 bits
+			DECIMAL_CONSTEXPR uint64_t scaled(uint64_t &hi) const
+			{
+				uint64_t lo = detail::mul64x64(whole_, fractionDenominator_, hi);
+				lo += fraction_;
+				hi += (lo < fraction_);
+				return lo;
+			}
+
+			template<typename Float>
+			static Decimal fromBinary(Float value)
+			{
+				DECIMAL_COUNT(FromBinary);
+				if(!std::isfinite(value))
+					DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - Decimal can not hold nan or infinity"));
+				Decimal ret;
+				if(value == 0)
+					return ret;
+				bool negative = value < 0;
+				int exponent = 0;
+				uint64_t mantissa = detail::binaryMantissa(negative ? -value : value, exponent);
+
+				bool overflow = false;
+				uint64_t whole = exponent >= 0 ? detail::scaleBinary(mantissa, exponent, 0, overflow) : (exponent > -64 ? mantissa >> -exponent : 0);
+				if(overflow)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				uint8_t wholeDigits = 0;
+				for(uint64_t w = whole; w > 0; w /= 10)
+					++wholeDigits;
+				const uint8_t significantDigits = std::numeric_limits<Float>::digits10 < FRACTION_DIGITS ? std::numeric_limits<Float>::digits10 : FRACTION_DIGITS;
+				if(wholeDigits <= significantDigits)
 				{
-					rhs.whole_ = 0;
-					missingWhole = true;
+					uint8_t digits = significantDigits - wholeDigits;
+					uint64_t value10 = detail::scaleBinary(mantissa, exponent, digits, overflow);
+					ret.whole_ = value10 / detail::pow10Table[digits];
+					ret.fraction_ = value10 % detail::pow10Table[digits] * detail::pow10Table[FRACTION_DIGITS - digits];
 				}
 				else
-					is >> rhs.whole_;
+				{
+					// only a few fraction bits can be left at this magnitude, they are kept exactly
+					ret.whole_ = whole;
+					ret.fraction_ = exponent < 0 ? detail::scaleBinary(mantissa & ((1ULL << -exponent) - 1), exponent, FRACTION_DIGITS, overflow) : 0;
+				}
+				ret.positive_ = !negative || (ret.whole_ == 0 && ret.fraction_ == 0);
+				return ret;
+			}
+
+			// (hi:lo) / fractionDenominator_, requires hi < fractionDenominator_
+			static DECIMAL_CONSTEXPR uint64_t divideByDenominator(uint64_t hi, uint64_t lo, uint64_t &rem)
+			{
+				return detail::div128by64Preinv(hi, lo, fractionDenominator_, fractionReciprocal_, rem);
+			}
+
+			// fraction += value modulo fractionDenominator_ without overflowing, returns the carry into whole_
+			static constexpr uint64_t addFraction(uint64_t &fraction, uint64_t value)
+			{
+				if(fraction >= fractionDenominator_ - value)
+				{
+					fraction -= fractionDenominator_ - value;
+					return 1;
+				}
+				fraction += value;
+				return 0;
+			}
+
+			constexpr void parse(const char *first, const char *last)
+			{
+				if(first == last)
+				{
+					positive_ = true;
+					whole_ = 0;
+					fraction_ = 0;
+					return;
+				}
+				from_chars_result res = from_chars(first, last, *this);
+				if(res.ec == std::errc::result_out_of_range)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - string constructor failed. value(" + std::string(first, last) + ")"));
+				if(res.ec != std::errc() || res.ptr != last)
+					DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - string constructor failed. value(" + std::string(first, last) + ")"));
+			}
+
+			bool positive_;
+			uint64_t whole_;
+			uint64_t fraction_;
+		};
+
+		namespace detail
+		{
+			// Parses [-|+]digits[.digits] straight from the streambuf's get area instead of peek() and >> per character.
+			struct StreamExtraction
+			{
+				typedef std::char_traits<char> traits;
 
-				if(is.peek() == '.')
+				static bool isDigit(traits::int_type c)
 				{
-					is >> ch;
-					if(missingWhole && !(is.peek() >= '0' && is.peek() <= '9'))
-						throw std::invalid_argument(__FILE__ ":" STR__LINE__ " - operator>> failed");
-					uint8_t m = FRACTION_DIGITS-1;
-					rhs.fraction_ = 0;
-					while(is.peek() >= '0' && is.peek() <= '9')
+					return c >= '0' && c <= '9';
+				}
+
+				// Parses one value from the current character on, returns the state bits for the stream.
+				// Fraction digits past FRACTION_DIGITS are consumed and truncated. Throws std::invalid_argument for '.' without digits.
+				static std::ios_base::iostate parse(std::streambuf &buf, Decimal &value)
+				{
+					DECIMAL_COUNT(StreamIn);
+					traits::int_type c = buf.sgetc();
+					bool positive = true;
+					if(c == '-' || c == '+')
+					{
+						positive = c == '+';
+						c = buf.snextc();
+					}
+
+					uint64_t whole = 0;
+					bool hasWhole = false, overflow = false;
+					for(; isDigit(c); c = buf.snextc())
 					{
-						is >> ch;
-						rhs.fraction_ += uint8_t(ch - '0') * constexpr_pow(10ULL, m);
-						if(m == 0)
-							break;
-						m--;
+						const uint64_t digit = uint64_t(c - '0');
+						overflow |= whole > (std::numeric_limits<uint64_t>::max() - digit) / 10;
+						whole = whole * 10 + digit;
+						hasWhole = true;
 					}
+					const std::ios_base::iostate eof = traits::eq_int_type(c, traits::eof()) ? std::ios_base::eofbit : std::ios_base::goodbit;
+					if(overflow)
+					{
+						// like operator>>(uint64_t): the largest value and failbit
+						value.positive_ = positive;
+						value.whole_ = std::numeric_limits<uint64_t>::max();
+						value.fraction_ = 0;
+						return std::ios_base::failbit | eof;
+					}
+
+					uint64_t fraction = 0;
+					if(c == '.')
+					{
+						c = buf.snextc();
+						if(!hasWhole && !isDigit(c))
+							DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - operator>> failed"));
+						uint16_t digits = 0;
+						for(; isDigit(c); c = buf.snextc())
+						{
+							if(digits < Decimal::FRACTION_DIGITS)
+							{
+								fraction = fraction * 10 + uint64_t(c - '0');
+								++digits;
+							}
+						}
+						fraction *= pow10Table[Decimal::FRACTION_DIGITS - digits];
+					}
+					else if(!hasWhole)
+					{
+						value = Decimal(0);
+						return std::ios_base::failbit | eof;
+					}
+
+					value.positive_ = positive || (whole == 0 && fraction == 0);
+					value.whole_ = whole;
+					value.fraction_ = fraction;
+					return traits::eq_int_type(c, traits::eof()) ? std::ios_base::eofbit : std::ios_base::goodbit;
 				}
-				else
-					rhs.fraction_ = 0;
-				return is;
+			};
+		}
+
+		inline std::istream& operator >> (std::istream& is, Decimal &rhs)
+		{
+			std::istream::sentry sentry(is);
+			if(sentry)
+				is.setstate(detail::StreamExtraction::parse(*is.rdbuf(), rhs));
+			return is;
+		}
+
+		// Reads whitespace separated Decimals into out until the end of the stream (eofbit) or the first text that is not a Decimal
+		// (failbit, like operator>>). Values are the same as a loop over operator>> but the stream is set up once for all of them.
+		template<typename OutputIt>
+		OutputIt read_decimals(std::istream &is, OutputIt out)
+		{
+			typedef detail::StreamExtraction::traits traits;
+			std::istream::sentry sentry(is, true);
+			if(!sentry)
+				return out;
+			std::streambuf &buf = *is.rdbuf();
+			const std::ctype<char> &ctype = std::use_facet<std::ctype<char> >(is.getloc());
+			std::ios_base::iostate state = std::ios_base::goodbit;
+			while(state == std::ios_base::goodbit)
+			{
+				traits::int_type c = buf.sgetc();
+				while(!traits::eq_int_type(c, traits::eof()) && ctype.is(std::ctype_base::space, traits::to_char_type(c)))
+					c = buf.snextc();
+				if(traits::eq_int_type(c, traits::eof()))
+				{
+					state = std::ios_base::eofbit;
+					break;
+				}
+				Decimal value;
+				state = detail::StreamExtraction::parse(buf, value);
+				if(!(state & std::ios_base::failbit))
+					*out++ = value;
 			}
+			is.setstate(state);
+			return out;
+		}
 
-			long double asDouble() const
+		// Divides Decimals by a fixed divisor with a reciprocal computed once (Moller & Granlund), so each divide is
+		// a few multiplies instead of hardware 128/64 divisions. Results are bit identical to the truncating
+		// Decimal::operator/ including whole part wrap around.
+		class DecimalDivisor
+		{
+		public:
+			DECIMAL_CONSTEXPR explicit DecimalDivisor(const Decimal &divisor) : negative_(divisor.negative()), kind_(Kind::Whole), shift_(0), d1_(0), d0_(0), v_(0)
+			{
+				if(divisor.whole_ == 0 && divisor.fraction_ == 0)
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero"));
+				if(divisor.fraction_ == 0)
+				{
+					// a / n == (a * 10^19) / (n * 10^19), so whole divisors only need the 64 bit n
+					initNarrow(divisor.whole_);
+					return;
+				}
+				uint64_t hi = 0, lo = divisor.scaled(hi);
+				if(hi == 0)
+				{
+					kind_ = Kind::Narrow;
+					initNarrow(lo);
+					return;
+				}
+				kind_ = Kind::Wide;
+				shift_ = detail::countLeadingZeros(hi);
+				d1_ = shift_ ? hi << shift_ | lo >> (64 - shift_) : hi;
+				d0_ = lo << shift_;
+				v_ = detail::reciprocal(d1_, d0_);
+			}
+
+			DECIMAL_CONSTEXPR explicit DecimalDivisor(uint64_t divisor) : negative_(false), kind_(Kind::Whole), shift_(0), d1_(0), d0_(0), v_(0)
+			{
+				if(divisor == 0)
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero"));
+				initNarrow(divisor);
+			}
+
+			DECIMAL_CONSTEXPR Decimal divide(const Decimal &dividend) const
 			{
-				return whole_ + (long double)(fraction_) / fractionDenominator_;
+				bool overflow = false, inexact = false;
+				return divide(dividend, overflow, inexact);
+			}
+
+			// out may alias values
+			void divide(const Decimal *values, size_t count, Decimal *out) const
+			{
+				for(size_t i = 0; i < count; ++i)
+					out[i] = divide(values[i]);
 			}
 
 		private:
-			void round(int8_t digits)// for 2.2222: -1 would be 2.2  &  1 would be 2
+			friend struct detail::CheckedArithmetic;
+
+			enum class Kind : uint8_t
 			{
-				if(digits < -FRACTION_DIGITS || digits > 20)
-					throw std::invalid_argument(__FILE__ ":" STR__LINE__ " - round failed");
-				if(digits >= 0)
+				Whole,// divisor has no fraction, d1_ is the normalized whole part
+				Narrow,// scaled divisor fits in 64 bits, d1_ is it normalized
+				Wide// scaled divisor needs 128 bits, d1_:d0_ is it normalized
+			};
+
+			// overflow is set when the whole part wrapped, inexact when the quotient was truncated
+			DECIMAL_CONSTEXPR Decimal divide(const Decimal &dividend, bool &overflow, bool &inexact) const
+			{
+				uint64_t hi = 0, lo = dividend.scaled(hi);
+				// dividend << shift_ as n2:n1:n0
+				uint64_t n2 = shift_ ? hi >> (64 - shift_) : 0;
+				uint64_t n1 = shift_ ? hi << shift_ | lo >> (64 - shift_) : hi;
+				uint64_t n0 = lo << shift_;
+
+				Decimal ret;
+				if(kind_ == Kind::Whole)
 				{
-					fraction_ = 0;
-					if(digits > 0)
-						whole_ = uint64_t(whole_ / constexpr_pow(10, static_cast<uint8_t>(digits))) * constexpr_pow(10LL, static_cast<uint8_t>(digits));
+					// quotient of the scaled values is the scaled result, n2 < d1_ so its quotient word is 0
+					uint64_t rem = 0;
+					uint64_t q1 = detail::div128by64Preinv(n2, n1, d1_, v_, rem);
+					uint64_t q0 = detail::div128by64Preinv(rem, n0, d1_, v_, rem);
+					inexact = rem != 0;
+					ret.whole_ = Decimal::divideByDenominator(q1, q0, ret.fraction_);
+				}
+				else if(kind_ == Kind::Narrow)
+				{
+					// whole part wraps modulo 2^64 like operator/, so the top quotient word is dropped
+					uint64_t rem = 0, pHi = 0;
+					overflow = detail::div128by64Preinv(n2, n1, d1_, v_, rem) != 0;
+					ret.whole_ = detail::div128by64Preinv(rem, n0, d1_, v_, rem);
+					uint64_t pLo = detail::mul64x64(rem, Decimal::fractionDenominator_, pHi);
+					ret.fraction_ = detail::div128by64Preinv(pHi, pLo, d1_, v_, rem);//truncate
+					inexact = rem != 0;
 				}
 				else
 				{
-					digits = FRACTION_DIGITS - abs(digits);
-					fraction_ = uint64_t(fraction_ / constexpr_pow(10, static_cast<uint8_t>(digits))) * constexpr_pow(10LL, static_cast<uint8_t>(digits));
+					uint64_t remHi = 0, remLo = 0, carry = 0, p2 = 0;
+					ret.whole_ = detail::div192by128Preinv(n2, n1, n0, d1_, d0_, v_, remHi, remLo);
+					uint64_t p0 = detail::mul64x64(remLo, Decimal::fractionDenominator_, carry);
+					uint64_t p1 = detail::mul64x64(remHi, Decimal::fractionDenominator_, p2);
+					p1 += carry;
+					p2 += (p1 < carry);
+					ret.fraction_ = detail::div192by128Preinv(p2, p1, p0, d1_, d0_, v_, remHi, remLo);//truncate
+					inexact = (remHi | remLo) != 0;
 				}
+				ret.positive_ = dividend.positive_ != negative_ || (ret.whole_ == 0 && ret.fraction_ == 0);
+				return ret;
 			}
 
-			std::string fractionAsString() const
+			DECIMAL_CONSTEXPR void initNarrow(uint64_t d)
 			{
-				if(fraction_ == 0)
-					return "0";
+				shift_ = detail::countLeadingZeros(d);
+				d1_ = d << shift_;
+				v_ = detail::reciprocal(d1_);
+			}
 
-				std::string res = std::to_string(fraction_);
-				while(res.size() < FRACTION_DIGITS)
-					res = "0" + res;
-				while(res.size() > 0 && res.back() == '0')
-					res.pop_back();
-				return res;
+			bool negative_;
+			Kind kind_;
+			uint8_t shift_;
+			uint64_t d1_;
+			uint64_t d0_;
+			uint64_t v_;
+		};
+
+		// Rounds to a multiple of 10^-digits with mode, dividing by the power of ten through a precomputed reciprocal.
+		// digits from -19 (multiples of 10^19) up, 19 or more leaves values unchanged.
+		class DecimalQuantizer
+		{
+		public:
+			// Throws std::invalid_argument for digits below -19.
+			DECIMAL_CONSTEXPR DecimalQuantizer(int digits, RoundingMode mode) : kind_(Kind::Identity), mode_(mode), shift_(0), parityMask_(0), unit_(1), half_(0), d1_(0), v_(0)
+			{
+				if(digits < -int(Decimal::FRACTION_DIGITS))
+					DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - quantize digits out of range"));
+				if(digits >= int(Decimal::FRACTION_DIGITS))
+					return;
+				const unsigned k = digits >= 0 ? unsigned(Decimal::FRACTION_DIGITS - digits) : unsigned(-digits);
+				kind_ = digits >= 0 ? Kind::Fraction : Kind::Whole;
+				parityMask_ = digits == 0 ? 1 : 0;
+				unit_ = detail::pow10Table[k];
+				half_ = unit_ / 2;
+				shift_ = uint8_t(detail::countLeadingZeros(unit_));
+				d1_ = unit_ << shift_;
+				v_ = detail::pow10ReciprocalTable[k];
 			}
 
-			bool positive_;
-			uint64_t whole_;
-			uint64_t fraction_;
+			// Throws std::out_of_range when rounding up passes the maximum.
+			DECIMAL_CONSTEXPR Decimal quantize(const Decimal &value) const
+			{
+				if(kind_ == Kind::Fraction)
+					return quantizeFraction(value);
+				if(kind_ == Kind::Whole)
+					return quantizeWhole(value);
+				return value;
+			}
+
+			// out may alias values
+			void quantize(const Decimal *values, size_t count, Decimal *out) const
+			{
+				if(kind_ == Kind::Fraction)
+				{
+					for(size_t i = 0; i < count; ++i)
+						out[i] = quantizeFraction(values[i]);
+				}
+				else if(kind_ == Kind::Whole)
+				{
+					for(size_t i = 0; i < count; ++i)
+						out[i] = quantizeWhole(values[i]);
+				}
+				else if(out != values)
+				{
+					for(size_t i = 0; i < count; ++i)
+						out[i] = values[i];
+				}
+			}
+
+		private:
+			enum class Kind : uint8_t
+			{
+				Identity,// 19 or more digits, nothing to round
+				Fraction,// unit_ divides fraction_
+				Whole// unit_ divides whole_, fraction_ only breaks ties
+			};
+
+			// (x << shift_) / d1_ as x / unit_
+			DECIMAL_CONSTEXPR uint64_t divide(uint64_t x, uint64_t &rem) const
+			{
+				const uint64_t q = detail::div128by64Preinv(shift_ ? x >> (64 - shift_) : 0, x << shift_, d1_, v_, rem);
+				rem >>= shift_;
+				return q;
+			}
+
+			DECIMAL_CONSTEXPR Decimal quantizeFraction(const Decimal &value) const
+			{
+				uint64_t rem = 0;
+				const uint64_t q = divide(value.fraction_, rem);
+				// with no fraction digit kept q is 0 and half even looks at the whole part's last digit
+				const uint64_t kept = q + detail::roundingIncrement(q | (value.whole_ & parityMask_), rem, unit_, value.negative(), mode_);
+				Decimal ret;
+				ret.fraction_ = kept * unit_;
+				const uint64_t carry = (ret.fraction_ == Decimal::fractionDenominator_);
+				ret.fraction_ = carry ? 0 : ret.fraction_;
+				ret.whole_ = value.whole_ + carry;
+				if(ret.whole_ < carry)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				ret.positive_ = value.positive_ || (ret.whole_ == 0 && ret.fraction_ == 0);
+				return ret;
+			}
+
+			DECIMAL_CONSTEXPR Decimal quantizeWhole(const Decimal &value) const
+			{
+				uint64_t rem = 0;
+				const uint64_t q = divide(value.whole_, rem);
+				// roundingIncrement's remainder classes with d == 4: 0 exact, 1 below half, 2 half, 3 above half
+				const uint64_t r = (rem == 0 && value.fraction_ == 0) ? 0 : (rem < half_ ? 1 : (rem == half_ && value.fraction_ == 0 ? 2 : 3));
+				uint64_t hi = 0;
+				Decimal ret;
+				ret.whole_ = detail::mul64x64(q + detail::roundingIncrement(q, r, 4, value.negative(), mode_), unit_, hi);
+				if(hi != 0)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				ret.fraction_ = 0;
+				ret.positive_ = value.positive_ || ret.whole_ == 0;
+				return ret;
+			}
+
+			Kind kind_;
+			RoundingMode mode_;
+			uint8_t shift_;
+			uint64_t parityMask_;
+			uint64_t unit_;
+			uint64_t half_;
+			uint64_t d1_;
+			uint64_t v_;
 		};
 
-		const constexpr uint16_t Decimal::FRACTION_DIGITS;
-		const constexpr uint64_t Decimal::fractionDenominator_;
-		const constexpr uint64_t Decimal::maxValue_;
+		// value rounded to a multiple of 10^-digits with mode, see DecimalQuantizer
+		DECIMAL_CONSTEXPR Decimal quantize(const Decimal &value, int digits, RoundingMode mode)
+		{
+			return DecimalQuantizer(digits, mode).quantize(value);
+		}
+
+		// out may alias values
+		inline void quantize(const Decimal *values, size_t count, Decimal *out, int digits, RoundingMode mode)
+		{
+			DecimalQuantizer(digits, mode).quantize(values, count, out);
+		}
 
-		Decimal operator/(const int64_t lhs, const Decimal &rhs)
+#ifndef DECIMAL_EXPRESSION_TEMPLATES
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr Decimal operator+(Int lhs, const Decimal &rhs)
 		{
-			return Decimal(lhs) / rhs;
+			return rhs + lhs;
 		}
 
-		std::string to_string(const Decimal &amount, boost::optional<size_t> precision = boost::none)
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr Decimal operator-(Int lhs, const Decimal &rhs)
 		{
-			std::stringstream tmpss;
-			tmpss << amount;
-			std::string tmp;
-			tmpss >> tmp;
+			return -(rhs - lhs);
+		}
 
-			if(!precision)
-				return tmp;
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		DECIMAL_CONSTEXPR Decimal operator*(Int lhs, const Decimal &rhs)
+		{
+			return rhs * lhs;
+		}
+
+		// the divisor is a Decimal, so this is the full division
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		DECIMAL_CONSTEXPR Decimal operator/(Int lhs, const Decimal &rhs)
+		{
+			Decimal tmp(static_cast<detail::IntegerOperand<Int>>(lhs));
+			tmp /= rhs;
+			return tmp;
+		}
+#endif
+
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr bool operator==(Int lhs, const Decimal &rhs)
+		{
+			return rhs == lhs;
+		}
+
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr bool operator!=(Int lhs, const Decimal &rhs)
+		{
+			return rhs != lhs;
+		}
+
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr bool operator<(Int lhs, const Decimal &rhs)
+		{
+			return rhs > lhs;
+		}
+
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr bool operator>(Int lhs, const Decimal &rhs)
+		{
+			return rhs < lhs;
+		}
+
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr bool operator<=(Int lhs, const Decimal &rhs)
+		{
+			return rhs >= lhs;
+		}
 
-			size_t pos = tmp.find('.');
-			if(*precision == 0)
+		template<typename Int, typename std::enable_if<detail::IsInteger<Int>::value, int>::type = 0>
+		constexpr bool operator>=(Int lhs, const Decimal &rhs)
+		{
+			return rhs <= lhs;
+		}
+
+		// Writes the shortest exact representation: no trailing fraction zeros and no '.' for whole values.
+		inline to_chars_result to_chars(char *first, char *last, const Decimal &value)
+		{
+			size_t precision = 0;
+			if(value.fraction_ != 0)
 			{
-				if(pos == std::string::npos)
-					return tmp;
-				else
-					return tmp.substr(0, pos);
+				uint64_t fraction = value.fraction_;
+				precision = Decimal::FRACTION_DIGITS;
+				while(fraction % 100 == 0)
+				{
+					fraction /= 100;
+					precision -= 2;
+				}
+				if(fraction % 10 == 0)
+					precision -= 1;
 			}
-			if(pos == std::string::npos)
+			return to_chars(first, last, value, precision);
+		}
+
+		// Writes exactly precision fraction digits, truncating or zero padding. precision 0 omits the '.'.
+		inline to_chars_result to_chars(char *first, char *last, const Decimal &value, size_t precision)
+		{
+			DECIMAL_COUNT(Format);
+			char wholeBuf[20];
+			char *wholeBegin = detail::writeDigitsBackward(wholeBuf + sizeof(wholeBuf), value.whole_);
+			size_t wholeLen = wholeBuf + sizeof(wholeBuf) - wholeBegin;
+			size_t len = (value.positive_ ? 0 : 1) + wholeLen + (precision ? 1 + precision : 0);
+			if(size_t(last - first) < len)
 			{
-				tmp += '.';
-				pos = tmp.find('.');
+				to_chars_result res = {last, std::errc::value_too_large};
+				return res;
 			}
-			while(tmp.size() < pos + 1 + *precision)
-				tmp += '0';
-			if(tmp.size() > pos + 1 + *precision)
-				return tmp.substr(0, pos + 1 + *precision);
+
+			if(!value.positive_)
+				*first++ = '-';
+			memcpy(first, wholeBegin, wholeLen);
+			first += wholeLen;
+			if(precision)
+			{
+				*first++ = '.';
+				size_t fracLen = precision < Decimal::FRACTION_DIGITS ? precision : Decimal::FRACTION_DIGITS;
+				char fracBuf[Decimal::FRACTION_DIGITS];
+				detail::writeNineteenDigits(fracBuf, value.fraction_);
+				memcpy(first, fracBuf, fracLen);
+				first += fracLen;
+				memset(first, '0', precision - fracLen);
+				first += precision - fracLen;
+			}
+			to_chars_result res = {first, std::errc()};
+			return res;
+		}
+
+		inline namespace literals
+		{
+			// 123.45_dec is parsed at compile time when used in a constant expression
+			constexpr Decimal operator""_dec(const char *value)
+			{
+				return Decimal(value);
+			}
+		}
+
+		inline std::string to_string(const Decimal &amount, boost::optional<size_t> precision = boost::none)
+		{
+			char buf[Decimal::MAX_STRING_LENGTH];
+			std::string res;
+			if(!precision)
+				res.assign(buf, to_chars(buf, buf + sizeof(buf), amount).ptr);
+			else if(*precision <= Decimal::FRACTION_DIGITS)
+				res.assign(buf, to_chars(buf, buf + sizeof(buf), amount, *precision).ptr);
 			else
-				return tmp;
+			{
+				res.assign(buf, to_chars(buf, buf + sizeof(buf), amount, Decimal::FRACTION_DIGITS).ptr);
+				res.append(*precision - Decimal::FRACTION_DIGITS, '0');
+			}
+			if(res.size() > std::string().capacity())
+				DECIMAL_COUNT(FormatAllocation);
+			return res;
+		}
+
+		// Nearest double to value (ties to even), the sign is kept
+		inline double to_double(const Decimal &value)
+		{
+			DECIMAL_COUNT(ToBinary);
+			uint64_t hi = 0, lo = value.scaled(hi);
+			return detail::toBinary<double>(value.negative(), hi, lo);
+		}
+
+		inline float to_float(const Decimal &value)
+		{
+			DECIMAL_COUNT(ToBinary);
+			uint64_t hi = 0, lo = value.scaled(hi);
+			return detail::toBinary<float>(value.negative(), hi, lo);
+		}
+
+		// Fixed point decimal stored as a single two's complement StorageT scaled by 10^FractionDigits.
+		// add/sub/compare are plain integer ops and + - wrap on overflow like the underlying integer.
+		// StorageT is int64_t (FractionDigits <= 18) or __int128 (FractionDigits == 19); the whole part always fits in uint64_t.
+		template<uint16_t FractionDigits, typename StorageT>
+		class BasicDecimal
+		{
+			typedef typename detail::UnsignedOf<StorageT>::type unsigned_type;
+
+		public:
+			typedef StorageT scaled_type;
+			static const constexpr uint16_t FRACTION_DIGITS = FractionDigits;
+
+		private:
+			static const constexpr uint64_t denominator_ = constexpr_pow(10ULL, FractionDigits);
+			static const constexpr unsigned shift_ = detail::countLeadingZeros(denominator_);
+			static const constexpr uint64_t reciprocal_ = detail::reciprocalConstexpr(denominator_ << shift_);
+			static const constexpr StorageT maxScaled_ = static_cast<StorageT>(~unsigned_type(0) >> 1);
+			static const constexpr uint64_t maxWhole_ = static_cast<uint64_t>(static_cast<unsigned_type>(maxScaled_) / denominator_);
+
+			static_assert(FractionDigits <= 19 && unsigned_type(maxScaled_) / denominator_ <= std::numeric_limits<uint64_t>::max(),
+				"BasicDecimal needs FractionDigits <= 19 and a whole part that fits in uint64_t");
+
+		public:
+			constexpr BasicDecimal() : value_(0)
+			{ }
+
+			constexpr BasicDecimal(int32_t value) : value_(scaledFromWhole(value < 0, value < 0 ? 0 - uint64_t(int64_t(value)) : uint64_t(value)))
+			{ }
+
+			constexpr BasicDecimal(uint32_t value) : value_(scaledFromWhole(false, value))
+			{ }
+
+			constexpr BasicDecimal(int64_t value) : value_(scaledFromWhole(value < 0, value < 0 ? 0 - uint64_t(value) : uint64_t(value)))
+			{ }
+
+			constexpr BasicDecimal(uint64_t value) : value_(scaledFromWhole(false, value))
+			{ }
+
+			// Converts from any other instantiation, including Decimal. Dropped fraction digits are rounded by mode.
+			// Throws std::out_of_range if the value does not fit.
+			template<uint16_t FD, typename S>
+			explicit DECIMAL_CONSTEXPR BasicDecimal(const BasicDecimal<FD, S> &value, RoundingMode mode = RoundingMode::Truncate) : value_(0)
+			{
+				bool overflow = false;
+				detail::uint128_t mag = detail::rescale(value.magnitude(), FD, FractionDigits, value.negative(), mode, overflow);
+				if(overflow || !fits(value.negative(), mag))
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - BasicDecimal conversion out of range"));
+				value_ = fromSignMagnitude(value.negative(), static_cast<unsigned_type>(mag)).value_;
+			}
+
+			// Evaluates the expression like Decimal(expression), then converts as above (DecimalExpression.hpp)
+			template<typename E>
+			explicit DECIMAL_CONSTEXPR BasicDecimal(const DecimalExpression<E> &expression, RoundingMode mode = RoundingMode::Truncate) : BasicDecimal(expression.evaluate(), mode)
+			{ }
+
+			// Fraction digits past FractionDigits are truncated like Decimal's
+			BasicDecimal(const std::string &value) : BasicDecimal(Decimal(value))
+			{ }
+
+			DECIMAL_CONSTEXPR BasicDecimal(const char value[]) : BasicDecimal(Decimal(value))
+			{ }
+
+			// always exact, every instantiation is representable as a Decimal
+			DECIMAL_CONSTEXPR operator Decimal() const
+			{
+				return Decimal(*this);
+			}
+
+			static constexpr BasicDecimal fromScaled(StorageT value)
+			{
+				BasicDecimal ret;
+				ret.value_ = value;
+				return ret;
+			}
+
+			constexpr StorageT scaled() const
+			{
+				return value_;
+			}
+
+			constexpr bool positive() const
+			{
+				return value_ >= 0;
+			}
+
+			DECIMAL_CONSTEXPR uint64_t whole() const
+			{
+				uint64_t fraction = 0;
+				return split(magnitude(), fraction);
+			}
+
+			DECIMAL_CONSTEXPR uint64_t fraction() const
+			{
+				uint64_t fraction = 0;
+				split(magnitude(), fraction);
+				return fraction;
+			}
+
+			static DECIMAL_CONSTEXPR from_chars_result from_chars(const char *first, const char *last, BasicDecimal &value)
+			{
+				Decimal tmp;
+				from_chars_result res = Decimal::from_chars(first, last, tmp);
+				if(res.ec == std::errc())
+				{
+					bool overflow = false;
+					detail::uint128_t mag = detail::rescale(tmp.magnitude(), Decimal::FRACTION_DIGITS, FractionDigits, tmp.negative(), RoundingMode::Truncate, overflow);
+					if(overflow || !fits(tmp.negative(), mag))
+						res.ec = std::errc::result_out_of_range;
+					else
+						value = fromSignMagnitude(tmp.negative(), static_cast<unsigned_type>(mag));
+				}
+				return res;
+			}
+
+			constexpr bool operator==(const BasicDecimal &rhs) const
+			{
+				return value_ == rhs.value_;
+			}
+
+			constexpr bool operator!=(const BasicDecimal &rhs) const
+			{
+				return value_ != rhs.value_;
+			}
+
+			constexpr bool operator>(const BasicDecimal &rhs) const
+			{
+				return value_ > rhs.value_;
+			}
+
+			constexpr bool operator>=(const BasicDecimal &rhs) const
+			{
+				return value_ >= rhs.value_;
+			}
+
+			constexpr bool operator<(const BasicDecimal &rhs) const
+			{
+				return value_ < rhs.value_;
+			}
+
+			constexpr bool operator<=(const BasicDecimal &rhs) const
+			{
+				return value_ <= rhs.value_;
+			}
+
+			constexpr BasicDecimal operator+(const BasicDecimal &rhs) const
+			{
+				return fromScaled(static_cast<StorageT>(static_cast<unsigned_type>(value_) + static_cast<unsigned_type>(rhs.value_)));
+			}
+
+			constexpr BasicDecimal& operator+=(const BasicDecimal &rhs)
+			{
+				return *this = *this + rhs;
+			}
+
+			constexpr BasicDecimal operator-() const
+			{
+				return fromScaled(static_cast<StorageT>(0 - static_cast<unsigned_type>(value_)));
+			}
+
+			constexpr BasicDecimal operator-(const BasicDecimal &rhs) const
+			{
+				return fromScaled(static_cast<StorageT>(static_cast<unsigned_type>(value_) - static_cast<unsigned_type>(rhs.value_)));
+			}
+
+			constexpr BasicDecimal& operator-=(const BasicDecimal &rhs)
+			{
+				return *this = *this - rhs;
+			}
+
+			// truncates toward zero like Decimal::operator*
+			DECIMAL_CONSTEXPR BasicDecimal operator*(const BasicDecimal &rhs) const
+			{
+				return fromSignMagnitude(negative() != rhs.negative(), multiply(magnitude(), rhs.magnitude()));
+			}
+
+			DECIMAL_CONSTEXPR BasicDecimal& operator*=(const BasicDecimal &rhs)
+			{
+				return *this = *this * rhs;
+			}
+
+			// truncates toward zero like Decimal::operator/
+			DECIMAL_CONSTEXPR BasicDecimal operator/(const BasicDecimal &rhs) const
+			{
+				if(rhs.value_ == 0)
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero"));
+				return fromSignMagnitude(negative() != rhs.negative(), divide(magnitude(), rhs.magnitude()));
+			}
+
+			DECIMAL_CONSTEXPR BasicDecimal& operator/=(const BasicDecimal &rhs)
+			{
+				return *this = *this / rhs;
+			}
+
+			long double asDouble() const
+			{
+				return static_cast<Decimal>(*this).asDouble();
+			}
+
+			friend std::ostream& operator<<(std::ostream& os, const BasicDecimal &rhs)
+			{
+				return os << static_cast<Decimal>(rhs);
+			}
+
+		private:
+			template<uint16_t, typename> friend class BasicDecimal;
+			friend struct detail::DecimalHash;
+
+			constexpr bool negative() const
+			{
+				return value_ < 0;
+			}
+
+			constexpr unsigned_type magnitude() const
+			{
+				return value_ < 0 ? 0 - static_cast<unsigned_type>(value_) : static_cast<unsigned_type>(value_);
+			}
+
+			static constexpr bool fits(bool negative, detail::uint128_t mag)
+			{
+				return mag <= static_cast<detail::uint128_t>(static_cast<unsigned_type>(maxScaled_)) + (negative ? 1 : 0);
+			}
+
+			static constexpr BasicDecimal fromSignMagnitude(bool negative, unsigned_type mag)
+			{
+				return fromScaled(static_cast<StorageT>(negative ? 0 - mag : mag));
+			}
+
+			static constexpr StorageT scaledFromWhole(bool negative, uint64_t whole)
+			{
+				if(whole > maxWhole_)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - BasicDecimal out of range"));
+				unsigned_type mag = static_cast<unsigned_type>(whole) * denominator_;
+				return static_cast<StorageT>(negative ? 0 - mag : mag);
+			}
+
+			// (hi:lo) / 10^FractionDigits with the precomputed reciprocal, requires hi < denominator_
+			static DECIMAL_CONSTEXPR uint64_t divideByDenominator(uint64_t hi, uint64_t lo, uint64_t &rem)
+			{
+				if(shift_)
+				{
+					hi = hi << shift_ | lo >> (64 - shift_);
+					lo <<= shift_;
+				}
+				uint64_t q = detail::div128by64Preinv(hi, lo, denominator_ << shift_, reciprocal_, rem);
+				rem >>= shift_;
+				return q;
+			}
+
+			static constexpr uint64_t split(uint64_t mag, uint64_t &fraction)
+			{
+				fraction = mag % denominator_;
+				return mag / denominator_;
+			}
+
+			static DECIMAL_CONSTEXPR uint64_t split(detail::uint128_t mag, uint64_t &fraction)
+			{
+				return divideByDenominator(static_cast<uint64_t>(mag >> 64), static_cast<uint64_t>(mag), fraction);
+			}
+
+			// a * b / 10^FractionDigits truncated, keeps the low bits on overflow
+			static DECIMAL_CONSTEXPR uint64_t multiply(uint64_t a, uint64_t b)
+			{
+				uint64_t hi = 0, rem = 0;
+				uint64_t lo = detail::mul64x64(a, b, hi);
+				return divideByDenominator(hi % denominator_, lo, rem);
+			}
+
+			static DECIMAL_CONSTEXPR detail::uint128_t multiply(detail::uint128_t a, detail::uint128_t b)
+			{
+				uint64_t a0 = static_cast<uint64_t>(a), a1 = static_cast<uint64_t>(a >> 64);
+				uint64_t b0 = static_cast<uint64_t>(b), b1 = static_cast<uint64_t>(b >> 64);
+
+				// 256 bit product p3:p2:p1:p0
+				uint64_t p0 = 0, p1 = 0, p2 = 0, p3 = 0, hi = 0, lo = 0;
+				p0 = detail::mul64x64(a0, b0, p1);
+				lo = detail::mul64x64(a0, b1, hi);
+				p1 += lo;
+				p2 = hi + (p1 < lo);
+				lo = detail::mul64x64(a1, b0, hi);
+				p1 += lo;
+				hi += (p1 < lo);
+				p2 += hi;
+				p3 = (p2 < hi);
+				lo = detail::mul64x64(a1, b1, hi);
+				p2 += lo;
+				p3 += hi + (p2 < lo);
+
+				uint64_t rem = 0, q1 = 0, q0 = 0;
+				divideByDenominator(0, p3, rem);
+				divideByDenominator(rem, p2, rem);
+				q1 = divideByDenominator(rem, p1, rem);
+				q0 = divideByDenominator(rem, p0, rem);
+				return (static_cast<detail::uint128_t>(q1) << 64) | q0;
+			}
+
+			// a * 10^FractionDigits / b truncated, keeps the low bits on overflow
+			static DECIMAL_CONSTEXPR uint64_t divide(uint64_t a, uint64_t b)
+			{
+				uint64_t hi = 0, rem = 0;
+				uint64_t lo = detail::mul64x64(a, denominator_, hi);
+				return detail::div128by64(hi % b, lo, b, rem);
+			}
+
+			static DECIMAL_CONSTEXPR detail::uint128_t divide(detail::uint128_t a, detail::uint128_t b)
+			{
+				// 192 bit numerator n2:n1:n0 = a * 10^FractionDigits
+				uint64_t n0 = 0, n1 = 0, n2 = 0, hi = 0;
+				n0 = detail::mul64x64(static_cast<uint64_t>(a), denominator_, n1);
+				uint64_t mid = detail::mul64x64(static_cast<uint64_t>(a >> 64), denominator_, n2);
+				n1 += mid;
+				n2 += (n1 < mid);
+
+				uint64_t q1 = 0, q0 = 0, bLo = static_cast<uint64_t>(b), bHi = static_cast<uint64_t>(b >> 64);
+				if(bHi == 0)
+				{
+					uint64_t rem = n2 % bLo;
+					q1 = detail::div128by64(rem, n1, bLo, rem);
+					q0 = detail::div128by64(rem, n0, bLo, rem);
+				}
+				else
+				{
+					uint64_t remHi = 0, remLo = 0;
+					q1 = detail::div192by128(0, n2, n1, bHi, bLo, remHi, remLo);
+					q0 = detail::div192by128(remHi, remLo, n0, bHi, bLo, remHi, hi);
+				}
+				return (static_cast<detail::uint128_t>(q1) << 64) | q0;
+			}
+
+			StorageT value_;
+		};
+
+		template<uint16_t FractionDigits, typename StorageT>
+		const constexpr uint16_t BasicDecimal<FractionDigits, StorageT>::FRACTION_DIGITS;
+		template<uint16_t FractionDigits, typename StorageT>
+		const constexpr uint64_t BasicDecimal<FractionDigits, StorageT>::denominator_;
+		template<uint16_t FractionDigits, typename StorageT>
+		const constexpr unsigned BasicDecimal<FractionDigits, StorageT>::shift_;
+		template<uint16_t FractionDigits, typename StorageT>
+		const constexpr uint64_t BasicDecimal<FractionDigits, StorageT>::reciprocal_;
+		template<uint16_t FractionDigits, typename StorageT>
+		const constexpr StorageT BasicDecimal<FractionDigits, StorageT>::maxScaled_;
+		template<uint16_t FractionDigits, typename StorageT>
+		const constexpr uint64_t BasicDecimal<FractionDigits, StorageT>::maxWhole_;
+
+		// Converts between instantiations, rounding dropped fraction digits by mode. Throws std::out_of_range if the value does not fit.
+		template<typename To, uint16_t FractionDigits, typename StorageT>
+		DECIMAL_CONSTEXPR To decimal_cast(const BasicDecimal<FractionDigits, StorageT> &value, RoundingMode mode = RoundingMode::Truncate)
+		{
+			return To(value, mode);
+		}
+
+		// 8 fraction digits in a single int64_t: Max 92233720368.54775807, Min -92233720368.54775808
+		typedef BasicDecimal<8, int64_t> Decimal64;
+
+#ifdef DECIMAL_NATIVE_INT128
+		// Decimal's resolution in 16 bytes instead of 24: Max 17014118346046923173.1687303715884105727, Min -17014118346046923173.1687303715884105728
+		typedef BasicDecimal<19, detail::int128_t> CompactDecimal;
+
+		static_assert(sizeof(CompactDecimal) == 16, "CompactDecimal must stay a single 128 bit integer");
+#endif
+		static_assert(sizeof(Decimal64) == 8, "Decimal64 must stay a single 64 bit integer");
+
+		namespace detail
+		{
+			// Hashes the stored integers, so equal values hash equal and -0 hashes like 0.
+			// The words are multiplied by odd constants, combined and finished with murmur3's fmix64.
+			struct DecimalHash
+			{
+				static uint64_t hash(const Decimal &value)
+				{
+					const bool negative = !value.positive_ && (value.whole_ | value.fraction_) != 0;
+					return fmix64((value.whole_ * 0x9e3779b97f4a7c15ULL) ^ (value.fraction_ * 0xc2b2ae3d27d4eb4fULL) ^ (negative ? 0x165667b19e3779f9ULL : 0));
+				}
+
+				template<uint16_t FractionDigits, typename StorageT>
+				static uint64_t hash(const BasicDecimal<FractionDigits, StorageT> &value)
+				{
+					return words(static_cast<typename UnsignedOf<StorageT>::type>(value.value_));
+				}
+
+				// operator== except -0 equals 0
+				static bool equal(const Decimal &a, const Decimal &b)
+				{
+					return a.whole_ == b.whole_ && a.fraction_ == b.fraction_ && (a.positive_ == b.positive_ || (a.whole_ | a.fraction_) == 0);
+				}
+
+			private:
+				static uint64_t fmix64(uint64_t k)
+				{
+					k ^= k >> 33;
+					k *= 0xff51afd7ed558ccdULL;
+					k ^= k >> 33;
+					k *= 0xc4ceb9fe1a85ec53ULL;
+					k ^= k >> 33;
+					return k;
+				}
+
+				static uint64_t words(uint64_t value)
+				{
+					return fmix64(value * 0x9e3779b97f4a7c15ULL);
+				}
+
+#ifdef DECIMAL_NATIVE_INT128
+				static uint64_t words(uint128_t value)
+				{
+					return fmix64((static_cast<uint64_t>(value >> 64) * 0x9e3779b97f4a7c15ULL) ^ (static_cast<uint64_t>(value) * 0xc2b2ae3d27d4eb4fULL));
+				}
+#endif
+			};
 		}
 	}
 }
+
+namespace std
+{
+	template<>
+	struct hash<tylawin::DataTypes::Decimal>
+	{
+		size_t operator()(const tylawin::DataTypes::Decimal &value) const noexcept
+		{
+			return static_cast<size_t>(tylawin::DataTypes::detail::DecimalHash::hash(value));
+		}
+	};
+
+	template<uint16_t FractionDigits, typename StorageT>
+	struct hash<tylawin::DataTypes::BasicDecimal<FractionDigits, StorageT> >
+	{
+		size_t operator()(const tylawin::DataTypes::BasicDecimal<FractionDigits, StorageT> &value) const noexcept
+		{
+			return static_cast<size_t>(tylawin::DataTypes::detail::DecimalHash::hash(value));
+		}
+	};
+}
+
+#ifdef DECIMAL_EXPRESSION_TEMPLATES
+// Decimal op Decimal builds lazy expressions evaluated with a single final rounding, see DecimalExpression.hpp
+#include "DecimalExpression.hpp"
+#endif
@@ -0,0 +1,131 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+#include "Decimal.hpp"
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		// Exact sum of any number of Decimals.
+		// Positive and negative values are summed separately as 128 bit whole and 128 bit fraction totals,
+		// so each add is two add-with-carry pairs and the 10^19 fraction carry is only resolved in result().
+		// Partial sums (e.g. one per thread) merge exactly.
+		class DecimalAccumulator
+		{
+		public:
+			DecimalAccumulator() : sums_()
+			{ }
+
+			void add(const Decimal &value)
+			{
+				Sum &sum = sums_[!value.positive_];
+				addWide(sum.wholeHi, sum.wholeLo, 0, value.whole_);
+				addWide(sum.fractionHi, sum.fractionLo, 0, value.fraction_);
+			}
+
+			void add(const Decimal *values, size_t count)
+			{
+				for(size_t i = 0; i < count; ++i)
+					add(values[i]);
+			}
+
+			template<typename InputIt>
+			void add(InputIt first, InputIt last)
+			{
+				for(; first != last; ++first)
+					add(*first);
+			}
+
+			void merge(const DecimalAccumulator &other)
+			{
+				for(int i = 0; i < 2; ++i)
+				{
+					addWide(sums_[i].wholeHi, sums_[i].wholeLo, other.sums_[i].wholeHi, other.sums_[i].wholeLo);
+					addWide(sums_[i].fractionHi, sums_[i].fractionLo, other.sums_[i].fractionHi, other.sums_[i].fractionLo);
+				}
+			}
+
+			void clear()
+			{
+				sums_[0] = Sum();
+				sums_[1] = Sum();
+			}
+
+			// throws std::out_of_range when the total does not fit in a Decimal
+			Decimal result() const
+			{
+				uint64_t posHi, posLo, negHi, negLo;
+				uint64_t posFraction = normalize(sums_[0], posHi, posLo);
+				uint64_t negFraction = normalize(sums_[1], negHi, negLo);
+
+				bool negative = negHi > posHi || (negHi == posHi && (negLo > posLo || (negLo == posLo && negFraction > posFraction)));
+				if(negative)
+				{
+					std::swap(posHi, negHi);
+					std::swap(posLo, negLo);
+					std::swap(posFraction, negFraction);
+				}
+				uint64_t borrow = posFraction < negFraction;
+				uint64_t fraction = posFraction - negFraction + (borrow ? Decimal::fractionDenominator_ : 0);
+				uint64_t wholeLo = posLo - negLo;
+				uint64_t wholeHi = posHi - negHi - (posLo < negLo);
+				wholeHi -= wholeLo < borrow;
+				wholeLo -= borrow;
+				if(wholeHi != 0)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - accumulated sum is too large for Decimal"));
+
+				Decimal ret;
+				ret.positive_ = !negative || (wholeLo == 0 && fraction == 0);
+				ret.whole_ = wholeLo;
+				ret.fraction_ = fraction;
+				return ret;
+			}
+
+		private:
+			struct Sum
+			{
+				uint64_t wholeHi;
+				uint64_t wholeLo;
+				uint64_t fractionHi;
+				uint64_t fractionLo;
+			};
+
+			static void addWide(uint64_t &hi, uint64_t &lo, uint64_t addHi, uint64_t addLo)
+			{
+				lo += addLo;
+				hi += addHi + (lo < addLo);
+			}
+
+			// whole + fraction carry into hi:lo, returns the remaining fraction
+			static uint64_t normalize(const Sum &sum, uint64_t &hi, uint64_t &lo)
+			{
+				uint64_t fraction = 0;
+				uint64_t carryHi = sum.fractionHi / Decimal::fractionDenominator_;
+				uint64_t carryLo = detail::div128by64(sum.fractionHi % Decimal::fractionDenominator_, sum.fractionLo, Decimal::fractionDenominator_, fraction);
+				hi = sum.wholeHi;
+				lo = sum.wholeLo;
+				addWide(hi, lo, carryHi, carryLo);
+				return fraction;
+			}
+
+			Sum sums_[2]; // [0] positive values, [1] negative values
+		};
+	}
+}
@@ -0,0 +1,394 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+#include "Decimal.hpp"
+
+#include <iterator>
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		// Binary encodings of Decimal, little endian on every platform.
+		//
+		// fixed:  17 bytes, whole (uint64) then fraction (uint64, 0 <= fraction < 10^19) then a flags byte (bit 0 = negative)
+		// varint: a header byte (bit 0 = negative, bits 1-5 = fraction digit count n), the whole part as LEB128,
+		//         then for n > 0 the fraction / 10^(19 - n) as LEB128. n is the fewest digits that hold the fraction.
+		//         0 takes 2 bytes, 12.5 takes 3, the widest value 21.
+		const constexpr size_t FIXED_ENCODED_SIZE = 17;
+		const constexpr size_t VARINT_MAX_ENCODED_SIZE = 21;
+
+		namespace detail
+		{
+			inline void storeLittleEndian(char *out, uint64_t value)
+			{
+				for(int i = 0; i < 8; ++i)
+					out[i] = char(value >> (8 * i));
+			}
+
+			inline uint64_t loadLittleEndian(const char *in)
+			{
+				uint64_t value = 0;
+				for(int i = 0; i < 8; ++i)
+					value |= uint64_t(uint8_t(in[i])) << (8 * i);
+				return value;
+			}
+
+			inline char* storeLeb128(char *out, uint64_t value)
+			{
+				while(value >= 0x80)
+				{
+					*out++ = char(value | 0x80);
+					value >>= 7;
+				}
+				*out++ = char(value);
+				return out;
+			}
+
+			inline from_chars_result loadLeb128(const char *first, const char *last, uint64_t &value)
+			{
+				from_chars_result res = {first, std::errc()};
+				value = 0;
+				for(unsigned shift = 0; ; shift += 7)
+				{
+					if(first == last)
+					{
+						res.ec = std::errc::invalid_argument;
+						return res;
+					}
+					uint8_t byte = uint8_t(*first++);
+					if(shift == 63 && byte > 1)
+					{
+						res.ec = std::errc::result_out_of_range;
+						return res;
+					}
+					if(byte == 0 && shift != 0)// overlong, the encoder never ends on an empty group
+					{
+						res.ec = std::errc::invalid_argument;
+						return res;
+					}
+					value |= uint64_t(byte & 0x7F) << shift;
+					if(!(byte & 0x80))
+						break;
+				}
+				res.ptr = first;
+				return res;
+			}
+
+			struct BinaryCodec
+			{
+				static char* encodeFixed(const Decimal &value, char *out)
+				{
+					storeLittleEndian(out, value.whole_);
+					storeLittleEndian(out + 8, value.fraction_);
+					out[16] = char(value.positive_ ? 0 : 1);
+					return out + FIXED_ENCODED_SIZE;
+				}
+
+				// no validation, see validFixed
+				static Decimal decodeFixed(const char *in)
+				{
+					Decimal ret;
+					ret.whole_ = loadLittleEndian(in);
+					ret.fraction_ = loadLittleEndian(in + 8);
+					ret.positive_ = !(in[16] & 1) || (ret.whole_ == 0 && ret.fraction_ == 0);
+					return ret;
+				}
+
+				static bool validFixed(const char *in)
+				{
+					return loadLittleEndian(in + 8) < Decimal::fractionDenominator_ && (uint8_t(in[16]) & ~1) == 0;
+				}
+
+				static char* encodeVarint(const Decimal &value, char *out)
+				{
+					uint64_t fraction = value.fraction_;
+					uint8_t digits = fraction ? Decimal::FRACTION_DIGITS : 0;
+					for(; digits > 0 && fraction % 10 == 0; --digits)
+						fraction /= 10;
+					*out++ = char((value.positive_ ? 0 : 1) | (digits << 1));
+					out = storeLeb128(out, value.whole_);
+					if(digits)
+						out = storeLeb128(out, fraction);
+					return out;
+				}
+
+				static from_chars_result decodeVarint(const char *first, const char *last, Decimal &value)
+				{
+					from_chars_result res = {first, std::errc::invalid_argument};
+					if(first == last)
+						return res;
+					uint8_t header = uint8_t(*first);
+					uint8_t digits = header >> 1;
+					if(digits > Decimal::FRACTION_DIGITS)
+						return res;
+					uint64_t whole = 0, fraction = 0;
+					from_chars_result part = loadLeb128(first + 1, last, whole);
+					if(part.ec == std::errc() && digits)
+					{
+						part = loadLeb128(part.ptr, last, fraction);
+						if(part.ec == std::errc() && (fraction >= pow10Table[digits] || fraction % 10 == 0))
+							part.ec = std::errc::invalid_argument;
+					}
+					if(part.ec != std::errc())
+					{
+						res.ec = part.ec;
+						return res;
+					}
+					value.whole_ = whole;
+					value.fraction_ = fraction * pow10Table[Decimal::FRACTION_DIGITS - digits];
+					value.positive_ = !(header & 1) || (whole == 0 && fraction == 0);
+					res.ptr = part.ptr;
+					res.ec = std::errc();
+					return res;
+				}
+			};
+		}
+
+		// writes FIXED_ENCODED_SIZE bytes, returns the end
+		inline char* encode_fixed(const Decimal &value, char *out)
+		{
+			return detail::BinaryCodec::encodeFixed(value, out);
+		}
+
+		// reads FIXED_ENCODED_SIZE bytes, ec is invalid_argument for a fraction >= 10^19 or unknown flags
+		inline from_chars_result decode_fixed(const char *first, const char *last, Decimal &value)
+		{
+			from_chars_result res = {first, std::errc::invalid_argument};
+			if(size_t(last - first) < FIXED_ENCODED_SIZE || !detail::BinaryCodec::validFixed(first))
+				return res;
+			value = detail::BinaryCodec::decodeFixed(first);
+			res.ptr = first + FIXED_ENCODED_SIZE;
+			res.ec = std::errc();
+			return res;
+		}
+
+		// writes at most VARINT_MAX_ENCODED_SIZE bytes, returns the end
+		inline char* encode_varint(const Decimal &value, char *out)
+		{
+			return detail::BinaryCodec::encodeVarint(value, out);
+		}
+
+		// ec is invalid_argument for truncated input or a malformed header or fraction, result_out_of_range when a part overflows 64 bits
+		inline from_chars_result decode_varint(const char *first, const char *last, Decimal &value)
+		{
+			return detail::BinaryCodec::decodeVarint(first, last, value);
+		}
+
+		// Batch versions. out needs count * FIXED_ENCODED_SIZE (fixed) or count * VARINT_MAX_ENCODED_SIZE (varint) bytes.
+		// Decoding stops at the first bad value, res.ptr points at it and values before it are written.
+
+		inline char* encode_fixed(const Decimal *values, size_t count, char *out)
+		{
+			for(size_t i = 0; i < count; ++i)
+				out = detail::BinaryCodec::encodeFixed(values[i], out);
+			return out;
+		}
+
+		inline from_chars_result decode_fixed(const char *first, const char *last, Decimal *values, size_t count)
+		{
+			from_chars_result res = {first, std::errc()};
+			for(size_t i = 0; i < count && res.ec == std::errc(); ++i)
+				res = decode_fixed(res.ptr, last, values[i]);
+			return res;
+		}
+
+		inline char* encode_varint(const Decimal *values, size_t count, char *out)
+		{
+			for(size_t i = 0; i < count; ++i)
+				out = detail::BinaryCodec::encodeVarint(values[i], out);
+			return out;
+		}
+
+		inline from_chars_result decode_varint(const char *first, const char *last, Decimal *values, size_t count)
+		{
+			from_chars_result res = {first, std::errc()};
+			for(size_t i = 0; i < count && res.ec == std::errc(); ++i)
+				res = detail::BinaryCodec::decodeVarint(res.ptr, last, values[i]);
+			return res;
+		}
+
+		// Read only view of fixed encoded Decimals in memory owned by someone else (an mmapped file, a receive buffer).
+		// Nothing is copied up front, elements are decoded when read. The buffer needs no alignment.
+		class DecimalSpanView
+		{
+		public:
+			class const_iterator
+			{
+			public:
+				typedef std::random_access_iterator_tag iterator_category;
+				typedef Decimal value_type;
+				typedef ptrdiff_t difference_type;
+				typedef const Decimal* pointer;
+				typedef Decimal reference;
+
+				const_iterator() : p_(nullptr)
+				{ }
+
+				explicit const_iterator(const char *p) : p_(p)
+				{ }
+
+				Decimal operator*() const
+				{
+					return detail::BinaryCodec::decodeFixed(p_);
+				}
+
+				Decimal operator[](difference_type n) const
+				{
+					return *(*this + n);
+				}
+
+				const_iterator& operator++()
+				{
+					p_ += FIXED_ENCODED_SIZE;
+					return *this;
+				}
+
+				const_iterator operator++(int)
+				{
+					const_iterator tmp(*this);
+					++*this;
+					return tmp;
+				}
+
+				const_iterator& operator--()
+				{
+					p_ -= FIXED_ENCODED_SIZE;
+					return *this;
+				}
+
+				const_iterator operator--(int)
+				{
+					const_iterator tmp(*this);
+					--*this;
+					return tmp;
+				}
+
+				const_iterator& operator+=(difference_type n)
+				{
+					p_ += n * difference_type(FIXED_ENCODED_SIZE);
+					return *this;
+				}
+
+				const_iterator& operator-=(difference_type n)
+				{
+					return *this += -n;
+				}
+
+				const_iterator operator+(difference_type n) const
+				{
+					return const_iterator(*this) += n;
+				}
+
+				const_iterator operator-(difference_type n) const
+				{
+					return const_iterator(*this) -= n;
+				}
+
+				difference_type operator-(const const_iterator &rhs) const
+				{
+					return (p_ - rhs.p_) / difference_type(FIXED_ENCODED_SIZE);
+				}
+
+				bool operator==(const const_iterator &rhs) const { return p_ == rhs.p_; }
+				bool operator!=(const const_iterator &rhs) const { return p_ != rhs.p_; }
+				bool operator<(const const_iterator &rhs) const { return p_ < rhs.p_; }
+				bool operator>(const const_iterator &rhs) const { return p_ > rhs.p_; }
+				bool operator<=(const const_iterator &rhs) const { return p_ <= rhs.p_; }
+				bool operator>=(const const_iterator &rhs) const { return p_ >= rhs.p_; }
+
+			private:
+				const char *p_;
+			};
+
+			DecimalSpanView() : data_(nullptr), size_(0)
+			{ }
+
+			// bytes must be a multiple of FIXED_ENCODED_SIZE
+			DecimalSpanView(const void *data, size_t bytes) : data_(static_cast<const char*>(data)), size_(bytes / FIXED_ENCODED_SIZE)
+			{
+				if(bytes % FIXED_ENCODED_SIZE != 0)
+					DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - buffer is not a whole number of encoded Decimals"));
+			}
+
+			size_t size() const
+			{
+				return size_;
+			}
+
+			bool empty() const
+			{
+				return size_ == 0;
+			}
+
+			// unchecked, an invalid fraction is returned as stored
+			Decimal operator[](size_t i) const
+			{
+				return detail::BinaryCodec::decodeFixed(data_ + i * FIXED_ENCODED_SIZE);
+			}
+
+			// throws std::out_of_range for i >= size() and std::invalid_argument for a corrupt element
+			Decimal at(size_t i) const
+			{
+				if(i >= size_)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - DecimalSpanView index out of range"));
+				if(!detail::BinaryCodec::validFixed(data_ + i * FIXED_ENCODED_SIZE))
+					DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - corrupt encoded Decimal"));
+				return (*this)[i];
+			}
+
+			// index of the first corrupt element, size() when all are valid
+			size_t validate() const
+			{
+				for(size_t i = 0; i < size_; ++i)
+				{
+					if(!detail::BinaryCodec::validFixed(data_ + i * FIXED_ENCODED_SIZE))
+						return i;
+				}
+				return size_;
+			}
+
+			DecimalSpanView subspan(size_t offset, size_t count) const
+			{
+				if(offset > size_ || count > size_ - offset)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - DecimalSpanView subspan out of range"));
+				return DecimalSpanView(data_ + offset * FIXED_ENCODED_SIZE, count * FIXED_ENCODED_SIZE);
+			}
+
+			const_iterator begin() const
+			{
+				return const_iterator(data_);
+			}
+
+			const_iterator end() const
+			{
+				return const_iterator(data_ + size_ * FIXED_ENCODED_SIZE);
+			}
+
+			const char* data() const
+			{
+				return data_;
+			}
+
+		private:
+			const char *data_;
+			size_t size_;
+		};
+	}
+}
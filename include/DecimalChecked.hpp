@@ -0,0 +1,277 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include "Decimal.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		// Bit flags in the style of IEEE decimal context status
+		enum class DecimalStatus : uint8_t
+		{
+			Ok = 0,
+			Overflow = 1,// whole part did not fit in 64 bits
+			DivisionByZero = 2,
+			Inexact = 4,// digits past the 19th fraction digit were truncated
+			Invalid = 8// malformed string, nan or infinity
+		};
+
+		constexpr DecimalStatus operator|(DecimalStatus lhs, DecimalStatus rhs)
+		{
+			return static_cast<DecimalStatus>(static_cast<uint8_t>(lhs) | static_cast<uint8_t>(rhs));
+		}
+
+		constexpr DecimalStatus operator&(DecimalStatus lhs, DecimalStatus rhs)
+		{
+			return static_cast<DecimalStatus>(static_cast<uint8_t>(lhs) & static_cast<uint8_t>(rhs));
+		}
+
+		constexpr DecimalStatus operator~(DecimalStatus value)
+		{
+			return static_cast<DecimalStatus>(~static_cast<uint8_t>(value) & 0xF);
+		}
+
+		inline DecimalStatus& operator|=(DecimalStatus &lhs, DecimalStatus rhs)
+		{
+			return lhs = lhs | rhs;
+		}
+
+		namespace detail
+		{
+			inline DecimalStatus& threadStatus()
+			{
+				static thread_local DecimalStatus status = DecimalStatus::Ok;
+				return status;
+			}
+
+			// The checked operations without touching the sticky flags
+			struct CheckedArithmetic
+			{
+				static DecimalStatus add(const Decimal &a, const Decimal &b, Decimal &result) noexcept
+				{
+					DecimalStatus status = DecimalStatus::Ok;
+					if(a.positive_ == b.positive_)// magnitudes only grow when the signs match
+					{
+						uint64_t whole = a.whole_ + b.whole_;
+						bool overflow = whole < a.whole_;
+						uint64_t fraction = a.fraction_;
+						overflow |= whole + Decimal::addFraction(fraction, b.fraction_) < whole;
+						if(overflow)
+							status = DecimalStatus::Overflow;
+					}
+					result = a + b;
+					return status;
+				}
+
+				// same steps as Decimal::operator* while tracking carries out of the whole part
+				static DecimalStatus multiply(const Decimal &a, const Decimal &b, Decimal &result) noexcept
+				{
+					uint64_t hi = 0, lo = 0, rem = 0;
+					lo = mul64x64(a.fraction_, b.fraction_, hi);
+					uint64_t fraction = Decimal::divideByDenominator(hi, lo, rem);
+					bool inexact = rem != 0;
+
+					uint64_t whole = mul64x64(a.whole_, b.whole_, hi);
+					bool overflow = hi != 0;
+					lo = mul64x64(a.whole_, b.fraction_, hi);
+					overflow |= addCarry(whole, Decimal::divideByDenominator(hi, lo, rem));
+					overflow |= addCarry(whole, Decimal::addFraction(fraction, rem));
+					lo = mul64x64(b.whole_, a.fraction_, hi);
+					overflow |= addCarry(whole, Decimal::divideByDenominator(hi, lo, rem));
+					overflow |= addCarry(whole, Decimal::addFraction(fraction, rem));
+
+					result.whole_ = whole;
+					result.fraction_ = fraction;
+					result.positive_ = a.positive_ == b.positive_ || (whole == 0 && fraction == 0);
+					return (overflow ? DecimalStatus::Overflow : DecimalStatus::Ok) | (inexact ? DecimalStatus::Inexact : DecimalStatus::Ok);
+				}
+
+				static DecimalStatus divide(const Decimal &a, const Decimal &b, Decimal &result) noexcept
+				{
+					if(b.whole_ == 0 && b.fraction_ == 0)
+					{
+						result = Decimal();
+						return DecimalStatus::DivisionByZero;
+					}
+					bool overflow = false, inexact = false;
+					result = DecimalDivisor(b).divide(a, overflow, inexact);
+					return (overflow ? DecimalStatus::Overflow : DecimalStatus::Ok) | (inexact ? DecimalStatus::Inexact : DecimalStatus::Ok);
+				}
+
+				static DecimalStatus fromChars(const char *first, const char *last, Decimal &result) noexcept
+				{
+					Decimal value;
+					from_chars_result res = Decimal::from_chars(first, last, value);
+					if(res.ec != std::errc() || res.ptr != last)
+					{
+						result = Decimal();
+						return res.ec == std::errc::result_out_of_range ? DecimalStatus::Overflow : DecimalStatus::Invalid;
+					}
+					result = value;
+					// fraction digits past the 19th are truncated by from_chars
+					const char *fraction = std::find(first, last, '.');
+					if(last - fraction > 1 + Decimal::FRACTION_DIGITS && std::find_if(fraction + 1 + Decimal::FRACTION_DIGITS, last, [](char c) { return c != '0'; }) != last)
+						return DecimalStatus::Inexact;
+					return DecimalStatus::Ok;
+				}
+
+				template<typename Float>
+				static DecimalStatus fromBinary(Float value, Decimal &result) noexcept
+				{
+					result = Decimal();
+					if(!std::isfinite(value))
+						return DecimalStatus::Invalid;
+					if(value == 0)
+						return DecimalStatus::Ok;
+					int exponent = 0;
+					uint64_t mantissa = binaryMantissa(value < 0 ? -value : value, exponent);
+					if(exponent >= 64 || (exponent > 0 && (mantissa >> (64 - exponent)) != 0))
+						return DecimalStatus::Overflow;
+					result = Decimal::fromBinary(value);
+
+					// exact when the binary value has at most 19 fraction digits and the rounding kept all of them
+					while(!(mantissa & 1))
+					{
+						mantissa >>= 1;
+						++exponent;
+					}
+					uint64_t whole = 0, fraction = 0;
+					if(exponent >= 0)
+						whole = mantissa << exponent;
+					else
+					{
+						unsigned shift = unsigned(-exponent);
+						if(shift > Decimal::FRACTION_DIGITS)
+							return DecimalStatus::Inexact;
+						whole = mantissa >> shift;
+						// m / 2^k == m * 5^k / 10^k
+						fraction = (mantissa & ((1ULL << shift) - 1)) * (pow10Table[shift] >> shift) * pow10Table[Decimal::FRACTION_DIGITS - shift];
+					}
+					return result.whole_ == whole && result.fraction_ == fraction ? DecimalStatus::Ok : DecimalStatus::Inexact;
+				}
+
+				// whole += value, returns true on carry out
+				static bool addCarry(uint64_t &whole, uint64_t value) noexcept
+				{
+					whole += value;
+					return whole < value;
+				}
+			};
+
+			template<typename Op>
+			inline DecimalStatus checkedBatch(const Decimal *a, const Decimal *b, size_t count, Decimal *out, Op op) noexcept
+			{
+				DecimalStatus status = DecimalStatus::Ok;
+				for(size_t i = 0; i < count; ++i)
+					status |= op(a[i], b[i], out[i]);
+				if(status != DecimalStatus::Ok)
+					threadStatus() |= status;
+				return status;
+			}
+
+			inline DecimalStatus raise(DecimalStatus status) noexcept
+			{
+				if(status != DecimalStatus::Ok)
+					threadStatus() |= status;
+				return status;
+			}
+		}
+
+		// Sticky flags of the calling thread: every checked_ call ORs its status in until cleared
+		inline DecimalStatus decimal_status() noexcept
+		{
+			return detail::threadStatus();
+		}
+
+		// clears the flags in mask, returns the flags as they were before
+		inline DecimalStatus clear_decimal_status(DecimalStatus mask = ~DecimalStatus::Ok) noexcept
+		{
+			DecimalStatus previous = detail::threadStatus();
+			detail::threadStatus() = previous & ~mask;
+			return previous;
+		}
+
+		inline void raise_decimal_status(DecimalStatus status) noexcept
+		{
+			detail::raise(status);
+		}
+
+		// Non-throwing arithmetic. Each returns the status of this operation and also raises it in the thread's flags.
+		// result is the value the operators would give (Overflow wraps the whole part, Inexact truncates),
+		// except DivisionByZero and Invalid which leave result 0.
+
+		inline DecimalStatus checked_add(const Decimal &a, const Decimal &b, Decimal &result) noexcept
+		{
+			return detail::raise(detail::CheckedArithmetic::add(a, b, result));
+		}
+
+		inline DecimalStatus checked_sub(const Decimal &a, const Decimal &b, Decimal &result) noexcept
+		{
+			return detail::raise(detail::CheckedArithmetic::add(a, -b, result));
+		}
+
+		inline DecimalStatus checked_mul(const Decimal &a, const Decimal &b, Decimal &result) noexcept
+		{
+			return detail::raise(detail::CheckedArithmetic::multiply(a, b, result));
+		}
+
+		inline DecimalStatus checked_div(const Decimal &a, const Decimal &b, Decimal &result) noexcept
+		{
+			return detail::raise(detail::CheckedArithmetic::divide(a, b, result));
+		}
+
+		// whole of [first, last) must parse, Overflow when the whole part is past uint64_t
+		inline DecimalStatus checked_from_chars(const char *first, const char *last, Decimal &result) noexcept
+		{
+			return detail::raise(detail::CheckedArithmetic::fromChars(first, last, result));
+		}
+
+		// same rounding as the double constructor, Inexact unless result equals value exactly
+		inline DecimalStatus checked_from_double(double value, Decimal &result) noexcept
+		{
+			return detail::raise(detail::CheckedArithmetic::fromBinary(value, result));
+		}
+
+		// Batch forms: out[i] = a[i] op b[i], the returned status is the OR over all elements and the thread's
+		// flags are touched once. out may alias a or b.
+
+		inline DecimalStatus checked_add(const Decimal *a, const Decimal *b, size_t count, Decimal *out) noexcept
+		{
+			return detail::checkedBatch(a, b, count, out, detail::CheckedArithmetic::add);
+		}
+
+		inline DecimalStatus checked_sub(const Decimal *a, const Decimal *b, size_t count, Decimal *out) noexcept
+		{
+			return detail::checkedBatch(a, b, count, out, [](const Decimal &l, const Decimal &r, Decimal &o) { return detail::CheckedArithmetic::add(l, -r, o); });
+		}
+
+		inline DecimalStatus checked_mul(const Decimal *a, const Decimal *b, size_t count, Decimal *out) noexcept
+		{
+			return detail::checkedBatch(a, b, count, out, detail::CheckedArithmetic::multiply);
+		}
+
+		inline DecimalStatus checked_div(const Decimal *a, const Decimal *b, size_t count, Decimal *out) noexcept
+		{
+			return detail::checkedBatch(a, b, count, out, detail::CheckedArithmetic::divide);
+		}
+	}
+}
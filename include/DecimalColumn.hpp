@@ -0,0 +1,495 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+#include "Decimal.hpp"
+
+#include <vector>
+
+// x86 builds compile AVX2 and AVX-512 kernels with per function target attributes and pick one at runtime.
+// Define DECIMAL_NO_SIMD to only build the scalar kernels.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && !defined(DECIMAL_NO_SIMD)
+#define DECIMAL_X86_SIMD 1
+#include <immintrin.h>
+#endif
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		enum class SimdLevel
+		{
+			Scalar,
+			AVX2,
+			AVX512
+		};
+
+		namespace detail
+		{
+			// raw component arrays of a DecimalColumn
+			struct ColumnView
+			{
+				const uint8_t *negative;
+				const uint64_t *whole;
+				const uint64_t *fraction;
+			};
+
+			struct ColumnOut
+			{
+				uint8_t *negative;
+				uint64_t *whole;
+				uint64_t *fraction;
+			};
+
+			const constexpr uint64_t columnDenominator = constexpr_pow(10ULL, Decimal::FRACTION_DIGITS);
+
+			// Decimal::operator+ on components. negateB turns it into operator-.
+			inline void addOne(bool na, uint64_t wa, uint64_t fa, bool nb, uint64_t wb, uint64_t fb, uint8_t &n, uint64_t &w, uint64_t &f)
+			{
+				if(na == nb)
+				{
+					uint64_t carry = (fa >= columnDenominator - fb);
+					f = carry ? fa - (columnDenominator - fb) : fa + fb;
+					w = wa + wb + carry;
+				}
+				else
+				{
+					if(wa < wb || (wa == wb && fa < fb))
+					{
+						std::swap(na, nb);
+						std::swap(wa, wb);
+						std::swap(fa, fb);
+					}
+					uint64_t borrow = (fa < fb);
+					f = fa - fb + (borrow ? columnDenominator : 0);
+					w = wa - wb - borrow;
+				}
+				n = na && (w | f);
+			}
+
+			inline void addScalar(ColumnView a, ColumnView b, bool negateB, ColumnOut out, size_t i, size_t n)
+			{
+				for(; i < n; ++i)
+					addOne(a.negative[i] != 0, a.whole[i], a.fraction[i], (b.negative[i] != 0) != negateB, b.whole[i], b.fraction[i], out.negative[i], out.whole[i], out.fraction[i]);
+			}
+
+			// Decimal's <, ==, > on components as -1, 0, 1
+			inline int8_t compareOne(bool na, uint64_t wa, uint64_t fa, bool nb, uint64_t wb, uint64_t fb)
+			{
+				if(na != nb)
+					return na ? -1 : 1;
+				int8_t mag = (wa != wb) ? (wa > wb ? 1 : -1) : (fa != fb ? (fa > fb ? 1 : -1) : 0);
+				return na ? -mag : mag;
+			}
+
+			inline void compareScalar(ColumnView a, ColumnView b, int8_t *out, size_t i, size_t n)
+			{
+				for(; i < n; ++i)
+					out[i] = compareOne(a.negative[i] != 0, a.whole[i], a.fraction[i], b.negative[i] != 0, b.whole[i], b.fraction[i]);
+			}
+
+#ifdef DECIMAL_X86_SIMD
+			__attribute__((target("avx2")))
+			inline __m256i cmpgtU64Avx2(__m256i x, __m256i y)
+			{
+				const __m256i bias = _mm256_set1_epi64x(INT64_MIN);
+				return _mm256_cmpgt_epi64(_mm256_xor_si256(x, bias), _mm256_xor_si256(y, bias));
+			}
+
+			// 4 sign bytes widened to all ones / all zero 64 bit lanes
+			__attribute__((target("avx2")))
+			inline __m256i loadNegativeAvx2(const uint8_t *p)
+			{
+				int32_t bytes;
+				memcpy(&bytes, p, sizeof(bytes));
+				return _mm256_sub_epi64(_mm256_setzero_si256(), _mm256_cvtepu8_epi64(_mm_cvtsi32_si128(bytes)));
+			}
+
+			__attribute__((target("avx2")))
+			inline void addAvx2(ColumnView a, ColumnView b, bool negateB, ColumnOut out, size_t n)
+			{
+				const __m256i den = _mm256_set1_epi64x(int64_t(columnDenominator));
+				const __m256i denMinus1 = _mm256_set1_epi64x(int64_t(columnDenominator - 1));
+				const __m256i flip = _mm256_set1_epi64x(negateB ? -1 : 0);
+				const __m256i zero = _mm256_setzero_si256();
+				size_t i = 0;
+				for(; i + 4 <= n; i += 4)
+				{
+					__m256i wa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.whole + i));
+					__m256i fa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.fraction + i));
+					__m256i wb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.whole + i));
+					__m256i fb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.fraction + i));
+					__m256i na = loadNegativeAvx2(a.negative + i);
+					__m256i nb = _mm256_xor_si256(loadNegativeAvx2(b.negative + i), flip);
+
+					// same sign: add magnitudes, carry when fa + fb >= 10^19
+					__m256i carry = cmpgtU64Avx2(fa, _mm256_sub_epi64(denMinus1, fb));
+					__m256i sumF = _mm256_sub_epi64(_mm256_add_epi64(fa, fb), _mm256_and_si256(carry, den));
+					__m256i sumW = _mm256_sub_epi64(_mm256_add_epi64(wa, wb), carry);
+
+					// different sign: larger magnitude minus smaller, sign of the larger
+					__m256i aLess = _mm256_or_si256(cmpgtU64Avx2(wb, wa), _mm256_and_si256(_mm256_cmpeq_epi64(wa, wb), cmpgtU64Avx2(fb, fa)));
+					__m256i xw = _mm256_blendv_epi8(wa, wb, aLess), yw = _mm256_blendv_epi8(wb, wa, aLess);
+					__m256i xf = _mm256_blendv_epi8(fa, fb, aLess), yf = _mm256_blendv_epi8(fb, fa, aLess);
+					__m256i xn = _mm256_blendv_epi8(na, nb, aLess);
+					__m256i borrow = cmpgtU64Avx2(yf, xf);
+					__m256i diffF = _mm256_add_epi64(_mm256_sub_epi64(xf, yf), _mm256_and_si256(borrow, den));
+					__m256i diffW = _mm256_add_epi64(_mm256_sub_epi64(xw, yw), borrow);
+
+					__m256i same = _mm256_cmpeq_epi64(na, nb);
+					__m256i w = _mm256_blendv_epi8(diffW, sumW, same);
+					__m256i f = _mm256_blendv_epi8(diffF, sumF, same);
+					__m256i neg = _mm256_blendv_epi8(xn, na, same);
+					neg = _mm256_andnot_si256(_mm256_cmpeq_epi64(_mm256_or_si256(w, f), zero), neg);
+
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out.whole + i), w);
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out.fraction + i), f);
+					int bits = _mm256_movemask_pd(_mm256_castsi256_pd(neg));
+					for(int j = 0; j < 4; ++j)
+						out.negative[i + j] = (bits >> j) & 1;
+				}
+				addScalar(a, b, negateB, out, i, n);
+			}
+
+			__attribute__((target("avx2")))
+			inline void compareAvx2(ColumnView a, ColumnView b, int8_t *out, size_t n)
+			{
+				size_t i = 0;
+				for(; i + 4 <= n; i += 4)
+				{
+					__m256i wa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.whole + i));
+					__m256i fa = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a.fraction + i));
+					__m256i wb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.whole + i));
+					__m256i fb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b.fraction + i));
+					__m256i na = loadNegativeAvx2(a.negative + i);
+					__m256i nb = loadNegativeAvx2(b.negative + i);
+
+					__m256i wEq = _mm256_cmpeq_epi64(wa, wb);
+					__m256i magGt = _mm256_or_si256(cmpgtU64Avx2(wa, wb), _mm256_and_si256(wEq, cmpgtU64Avx2(fa, fb)));
+					__m256i magLt = _mm256_or_si256(cmpgtU64Avx2(wb, wa), _mm256_and_si256(wEq, cmpgtU64Avx2(fb, fa)));
+					__m256i same = _mm256_cmpeq_epi64(na, nb);
+					// both negative swaps the magnitude order, different signs are decided by a's sign
+					__m256i gt = _mm256_blendv_epi8(nb, _mm256_blendv_epi8(magGt, magLt, na), same);
+					__m256i lt = _mm256_blendv_epi8(na, _mm256_blendv_epi8(magLt, magGt, na), same);
+
+					int gtBits = _mm256_movemask_pd(_mm256_castsi256_pd(gt));
+					int ltBits = _mm256_movemask_pd(_mm256_castsi256_pd(lt));
+					for(int j = 0; j < 4; ++j)
+						out[i + j] = int8_t(((gtBits >> j) & 1) - ((ltBits >> j) & 1));
+				}
+				compareScalar(a, b, out, i, n);
+			}
+
+			// 8 sign bytes (each 0 or 1) gathered into a lane mask
+			inline uint8_t loadNegativeMask(const uint8_t *p)
+			{
+				uint64_t bytes;
+				memcpy(&bytes, p, sizeof(bytes));
+				return uint8_t((bytes * 0x0102040810204080ULL) >> 56);
+			}
+
+			__attribute__((target("avx512f")))
+			inline void addAvx512(ColumnView a, ColumnView b, bool negateB, ColumnOut out, size_t n)
+			{
+				const __m512i den = _mm512_set1_epi64(int64_t(columnDenominator));
+				const __m512i denMinus1 = _mm512_set1_epi64(int64_t(columnDenominator - 1));
+				const __m512i one = _mm512_set1_epi64(1);
+				const __mmask8 flip = negateB ? 0xFF : 0;
+				size_t i = 0;
+				for(; i + 8 <= n; i += 8)
+				{
+					__m512i wa = _mm512_loadu_si512(a.whole + i);
+					__m512i fa = _mm512_loadu_si512(a.fraction + i);
+					__m512i wb = _mm512_loadu_si512(b.whole + i);
+					__m512i fb = _mm512_loadu_si512(b.fraction + i);
+					__mmask8 na = loadNegativeMask(a.negative + i);
+					__mmask8 nb = loadNegativeMask(b.negative + i) ^ flip;
+
+					__mmask8 carry = _mm512_cmpgt_epu64_mask(fa, _mm512_sub_epi64(denMinus1, fb));
+					__m512i sumF = _mm512_add_epi64(fa, fb);
+					sumF = _mm512_mask_sub_epi64(sumF, carry, sumF, den);
+					__m512i sumW = _mm512_add_epi64(wa, wb);
+					sumW = _mm512_mask_add_epi64(sumW, carry, sumW, one);
+
+					__mmask8 aLess = _mm512_cmplt_epu64_mask(wa, wb) | (_mm512_cmpeq_epu64_mask(wa, wb) & _mm512_cmplt_epu64_mask(fa, fb));
+					__m512i xw = _mm512_mask_blend_epi64(aLess, wa, wb), yw = _mm512_mask_blend_epi64(aLess, wb, wa);
+					__m512i xf = _mm512_mask_blend_epi64(aLess, fa, fb), yf = _mm512_mask_blend_epi64(aLess, fb, fa);
+					__mmask8 xn = (aLess & nb) | (~aLess & na);
+					__mmask8 borrow = _mm512_cmplt_epu64_mask(xf, yf);
+					__m512i diffF = _mm512_sub_epi64(xf, yf);
+					diffF = _mm512_mask_add_epi64(diffF, borrow, diffF, den);
+					__m512i diffW = _mm512_sub_epi64(xw, yw);
+					diffW = _mm512_mask_sub_epi64(diffW, borrow, diffW, one);
+
+					__mmask8 same = ~(na ^ nb);
+					__m512i w = _mm512_mask_blend_epi64(same, diffW, sumW);
+					__m512i f = _mm512_mask_blend_epi64(same, diffF, sumF);
+					__mmask8 neg = ((same & na) | (~same & xn)) & _mm512_test_epi64_mask(_mm512_or_si512(w, f), _mm512_or_si512(w, f));
+
+					_mm512_storeu_si512(out.whole + i, w);
+					_mm512_storeu_si512(out.fraction + i, f);
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(out.negative + i), _mm512_maskz_cvtepi64_epi8(0xFF, _mm512_maskz_mov_epi64(neg, one)));
+				}
+				addScalar(a, b, negateB, out, i, n);
+			}
+
+			__attribute__((target("avx512f")))
+			inline void compareAvx512(ColumnView a, ColumnView b, int8_t *out, size_t n)
+			{
+				const __m512i one = _mm512_set1_epi64(1);
+				size_t i = 0;
+				for(; i + 8 <= n; i += 8)
+				{
+					__m512i wa = _mm512_loadu_si512(a.whole + i);
+					__m512i fa = _mm512_loadu_si512(a.fraction + i);
+					__m512i wb = _mm512_loadu_si512(b.whole + i);
+					__m512i fb = _mm512_loadu_si512(b.fraction + i);
+					__mmask8 na = loadNegativeMask(a.negative + i);
+					__mmask8 nb = loadNegativeMask(b.negative + i);
+
+					__mmask8 wEq = _mm512_cmpeq_epu64_mask(wa, wb);
+					__mmask8 magGt = _mm512_cmpgt_epu64_mask(wa, wb) | (wEq & _mm512_cmpgt_epu64_mask(fa, fb));
+					__mmask8 magLt = _mm512_cmplt_epu64_mask(wa, wb) | (wEq & _mm512_cmplt_epu64_mask(fa, fb));
+					__mmask8 same = ~(na ^ nb);
+					__mmask8 gt = (same & ((~na & magGt) | (na & magLt))) | (~same & nb);
+					__mmask8 lt = (same & ((~na & magLt) | (na & magGt))) | (~same & na);
+
+					__m512i res = _mm512_sub_epi64(_mm512_maskz_mov_epi64(gt, one), _mm512_maskz_mov_epi64(lt, one));
+					_mm_storel_epi64(reinterpret_cast<__m128i*>(out + i), _mm512_maskz_cvtepi64_epi8(0xFF, res));
+				}
+				compareScalar(a, b, out, i, n);
+			}
+#endif
+
+			inline SimdLevel detectSimdLevel()
+			{
+#ifdef DECIMAL_X86_SIMD
+				__builtin_cpu_init();
+				if(__builtin_cpu_supports("avx512f"))
+					return SimdLevel::AVX512;
+				if(__builtin_cpu_supports("avx2"))
+					return SimdLevel::AVX2;
+#endif
+				return SimdLevel::Scalar;
+			}
+
+			inline void add(SimdLevel level, ColumnView a, ColumnView b, bool negateB, ColumnOut out, size_t n)
+			{
+				switch(level)
+				{
+#ifdef DECIMAL_X86_SIMD
+				case SimdLevel::AVX512:
+					return addAvx512(a, b, negateB, out, n);
+				case SimdLevel::AVX2:
+					return addAvx2(a, b, negateB, out, n);
+#endif
+				default:
+					return addScalar(a, b, negateB, out, 0, n);
+				}
+			}
+
+			inline void compare(SimdLevel level, ColumnView a, ColumnView b, int8_t *out, size_t n)
+			{
+				switch(level)
+				{
+#ifdef DECIMAL_X86_SIMD
+				case SimdLevel::AVX512:
+					return compareAvx512(a, b, out, n);
+				case SimdLevel::AVX2:
+					return compareAvx2(a, b, out, n);
+#endif
+				default:
+					return compareScalar(a, b, out, 0, n);
+				}
+			}
+		}
+
+		// widest kernel set supported by this cpu, detected once
+		inline SimdLevel simdLevel()
+		{
+			static const SimdLevel level = detail::detectSimdLevel();
+			return level;
+		}
+
+		// Structure of arrays storage for Decimals: sign, whole and fraction parts each in their own contiguous array
+		class DecimalColumn
+		{
+		public:
+			DecimalColumn()
+			{ }
+
+			explicit DecimalColumn(size_t size) : negative_(size), whole_(size), fraction_(size)
+			{ }
+
+			template<typename InputIt>
+			DecimalColumn(InputIt first, InputIt last)
+			{
+				for(; first != last; ++first)
+					push_back(*first);
+			}
+
+			size_t size() const
+			{
+				return whole_.size();
+			}
+
+			bool empty() const
+			{
+				return whole_.empty();
+			}
+
+			void reserve(size_t size)
+			{
+				negative_.reserve(size);
+				whole_.reserve(size);
+				fraction_.reserve(size);
+			}
+
+			void resize(size_t size)
+			{
+				negative_.resize(size);
+				whole_.resize(size);
+				fraction_.resize(size);
+			}
+
+			void clear()
+			{
+				negative_.clear();
+				whole_.clear();
+				fraction_.clear();
+			}
+
+			void push_back(const Decimal &value)
+			{
+				negative_.push_back(!value.positive_);
+				whole_.push_back(value.whole_);
+				fraction_.push_back(value.fraction_);
+			}
+
+			void append(const DecimalColumn &other)
+			{
+				negative_.insert(negative_.end(), other.negative_.begin(), other.negative_.end());
+				whole_.insert(whole_.end(), other.whole_.begin(), other.whole_.end());
+				fraction_.insert(fraction_.end(), other.fraction_.begin(), other.fraction_.end());
+			}
+
+			Decimal operator[](size_t i) const
+			{
+				Decimal ret;
+				ret.positive_ = !negative_[i];
+				ret.whole_ = whole_[i];
+				ret.fraction_ = fraction_[i];
+				return ret;
+			}
+
+			void set(size_t i, const Decimal &value)
+			{
+				negative_[i] = !value.positive_;
+				whole_[i] = value.whole_;
+				fraction_[i] = value.fraction_;
+			}
+
+			const uint8_t* negative() const
+			{
+				return negative_.data();
+			}
+
+			const uint64_t* whole() const
+			{
+				return whole_.data();
+			}
+
+			const uint64_t* fraction() const
+			{
+				return fraction_.data();
+			}
+
+			detail::ColumnView view() const
+			{
+				detail::ColumnView v = {negative_.data(), whole_.data(), fraction_.data()};
+				return v;
+			}
+
+			detail::ColumnOut out()
+			{
+				detail::ColumnOut o = {negative_.data(), whole_.data(), fraction_.data()};
+				return o;
+			}
+
+		private:
+			std::vector<uint8_t> negative_;
+			std::vector<uint64_t> whole_;
+			std::vector<uint64_t> fraction_;
+		};
+
+		// Elementwise kernels, bit identical to the scalar Decimal operators including whole part wrap around.
+		// out is resized to match and may be the same column as an input.
+
+		inline void add(const DecimalColumn &a, const DecimalColumn &b, DecimalColumn &out)
+		{
+			if(a.size() != b.size())
+				DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - column size mismatch"));
+			out.resize(a.size());
+			detail::add(simdLevel(), a.view(), b.view(), false, out.out(), a.size());
+		}
+
+		inline void subtract(const DecimalColumn &a, const DecimalColumn &b, DecimalColumn &out)
+		{
+			if(a.size() != b.size())
+				DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - column size mismatch"));
+			out.resize(a.size());
+			detail::add(simdLevel(), a.view(), b.view(), true, out.out(), a.size());
+		}
+
+		// There is no vector 64x64->128 multiply on AVX2/AVX-512F, so this runs Decimal::operator* per element
+		inline void multiply(const DecimalColumn &a, const Decimal &scalar, DecimalColumn &out)
+		{
+			out.resize(a.size());
+			for(size_t i = 0; i < a.size(); ++i)
+				out.set(i, a[i] * scalar);
+		}
+
+		inline void divide(const DecimalColumn &a, const DecimalDivisor &divisor, DecimalColumn &out)
+		{
+			out.resize(a.size());
+			for(size_t i = 0; i < a.size(); ++i)
+				out.set(i, divisor.divide(a[i]));
+		}
+
+		inline void negate(const DecimalColumn &a, DecimalColumn &out)
+		{
+			out.resize(a.size());
+			detail::ColumnView in = a.view();
+			detail::ColumnOut o = out.out();
+			for(size_t i = 0; i < a.size(); ++i)
+			{
+				o.whole[i] = in.whole[i];
+				o.fraction[i] = in.fraction[i];
+				o.negative[i] = (in.negative[i] == 0) & ((in.whole[i] | in.fraction[i]) != 0);
+			}
+		}
+
+		// out[i] is -1, 0 or 1 for a[i] <, ==, > b[i]; out must hold a.size() elements
+		inline void compare(const DecimalColumn &a, const DecimalColumn &b, int8_t *out)
+		{
+			if(a.size() != b.size())
+				DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - column size mismatch"));
+			detail::compare(simdLevel(), a.view(), b.view(), out, a.size());
+		}
+	}
+}
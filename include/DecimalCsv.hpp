@@ -0,0 +1,364 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+#include "DecimalColumn.hpp"
+#include "DecimalParallel.hpp"
+
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define DECIMAL_CSV_SSE2 1
+#endif
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		// Read only memory map of a whole file, throws std::runtime_error if it can not be opened
+		class MappedFile
+		{
+		public:
+			explicit MappedFile(const std::string &path) : data_(nullptr), size_(0)
+			{
+#ifdef _WIN32
+				file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+				LARGE_INTEGER size;
+				if(file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &size))
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - can not open " + path));
+				size_ = static_cast<size_t>(size.QuadPart);
+				mapping_ = nullptr;
+				if(size_ == 0)
+					return;
+				mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if(mapping_ != nullptr)
+					data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+				if(data_ == nullptr)
+				{
+					close();
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - can not map " + path));
+				}
+#else
+				fd_ = ::open(path.c_str(), O_RDONLY);
+				struct stat st;
+				if(fd_ < 0 || fstat(fd_, &st) != 0)
+				{
+					close();
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - can not open " + path));
+				}
+				size_ = static_cast<size_t>(st.st_size);
+				if(size_ == 0)
+					return;
+				void *data = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+				if(data == MAP_FAILED)
+				{
+					close();
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - can not map " + path));
+				}
+				data_ = static_cast<const char*>(data);
+				madvise(data, size_, MADV_SEQUENTIAL);
+#endif
+			}
+
+			~MappedFile()
+			{
+				close();
+			}
+
+			MappedFile(const MappedFile&) = delete;
+			MappedFile& operator=(const MappedFile&) = delete;
+
+			const char* data() const
+			{
+				return data_;
+			}
+
+			size_t size() const
+			{
+				return size_;
+			}
+
+		private:
+			void close()
+			{
+#ifdef _WIN32
+				if(data_ != nullptr)
+					UnmapViewOfFile(data_);
+				if(mapping_ != nullptr)
+					CloseHandle(mapping_);
+				if(file_ != INVALID_HANDLE_VALUE)
+					CloseHandle(file_);
+				file_ = INVALID_HANDLE_VALUE;
+				mapping_ = nullptr;
+#else
+				if(data_ != nullptr)
+					munmap(const_cast<char*>(data_), size_);
+				if(fd_ >= 0)
+					::close(fd_);
+				fd_ = -1;
+#endif
+				data_ = nullptr;
+			}
+
+			const char *data_;
+			size_t size_;
+#ifdef _WIN32
+			HANDLE file_;
+			HANDLE mapping_;
+#else
+			int fd_;
+#endif
+		};
+
+		struct CsvOptions
+		{
+			char delimiter = ',';
+			bool hasHeader = false;
+			// field indices to load, in output order, a field may be listed more than once; empty loads every field of the first row
+			std::vector<size_t> columns;
+		};
+
+		// a row that was skipped because one of its loaded fields is not a Decimal or is missing
+		struct CsvError
+		{
+			size_t offset; // byte offset of the bad field (of the line end when the field is missing)
+			size_t row;    // data row number, not counting the header
+			size_t column; // index into CsvOptions::columns
+			std::errc ec;  // invalid_argument or result_out_of_range like from_chars
+		};
+
+		struct CsvResult
+		{
+			std::vector<DecimalColumn> columns;
+			std::vector<CsvError> errors;
+			size_t rows = 0; // data rows read including the skipped ones
+		};
+
+		namespace detail
+		{
+			inline unsigned countTrailingZeros(uint32_t x)// x != 0
+			{
+#if defined(__GNUC__)
+				return __builtin_ctz(x);
+#else
+				unsigned n = 0;
+				for(; !(x & 1); x >>= 1)
+					++n;
+				return n;
+#endif
+			}
+
+			// first of delimiter or '\n' in [first, last), last if neither
+			inline const char* findFieldEnd(const char *first, const char *last, char delimiter)
+			{
+#ifdef DECIMAL_CSV_SSE2
+				const __m128i delim = _mm_set1_epi8(delimiter);
+				const __m128i newline = _mm_set1_epi8('\n');
+				for(; last - first >= 16; first += 16)
+				{
+					__m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+					int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(chunk, delim), _mm_cmpeq_epi8(chunk, newline)));
+					if(mask != 0)
+						return first + countTrailingZeros(uint32_t(mask));
+				}
+#endif
+				while(first != last && *first != delimiter && *first != '\n')
+					++first;
+				return first;
+			}
+
+			// Decimal(std::string) rules without the exceptions: empty is 0, anything after the number is invalid
+			inline std::errc parseField(const char *first, const char *last, Decimal &value)
+			{
+				if(first == last)
+				{
+					value = Decimal();
+					return std::errc();
+				}
+				from_chars_result res = Decimal::from_chars(first, last, value);
+				if(res.ec == std::errc() && res.ptr != last)
+					return std::errc::invalid_argument;
+				return res.ec;
+			}
+
+			inline size_t countFields(const char *first, const char *last, char delimiter)
+			{
+				size_t count = 1;
+				for(const char *p = findFieldEnd(first, last, delimiter); p != last && *p != '\n'; p = findFieldEnd(p + 1, last, delimiter))
+					++count;
+				return count;
+			}
+
+			struct CsvChunk
+			{
+				std::vector<DecimalColumn> columns;
+				std::vector<CsvError> errors;
+				size_t rows;
+			};
+
+			// parses the lines starting in [first, last), base is the start of the whole buffer.
+			// slotOf maps a field index to the first slot loading it, later slots with the same field copy that one.
+			inline void parseCsvChunk(const char *base, const char *first, const char *last, const char *end, const CsvOptions &options, const std::vector<size_t> &slotOf, CsvChunk &chunk)
+			{
+				size_t columnCount = options.columns.size();
+				chunk.columns.assign(columnCount, DecimalColumn());
+				chunk.rows = 0;
+				std::vector<Decimal> row(columnCount);
+				std::vector<uint8_t> found(columnCount);
+				while(first < last)
+				{
+					const char *lineEnd = static_cast<const char*>(memchr(first, '\n', end - first));
+					if(lineEnd == nullptr)
+						lineEnd = end;
+					const char *contentEnd = (lineEnd != first && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd;
+					const char *next = lineEnd == end ? end : lineEnd + 1;
+					if(contentEnd == first)
+					{
+						first = next;
+						continue;
+					}
+
+					std::fill(found.begin(), found.end(), 0);
+					bool good = true;
+					const char *field = first;
+					for(size_t index = 0; good; ++index)
+					{
+						const char *fieldEnd = findFieldEnd(field, contentEnd, options.delimiter);
+						if(index < slotOf.size() && slotOf[index] != size_t(-1))
+						{
+							size_t slot = slotOf[index];
+							std::errc ec = parseField(field, fieldEnd, row[slot]);
+							if(ec != std::errc())
+							{
+								CsvError error = {size_t(field - base), chunk.rows, slot, ec};
+								chunk.errors.push_back(error);
+								good = false;
+							}
+							found[slot] = 1;
+						}
+						if(fieldEnd == contentEnd || index + 1 >= slotOf.size())
+							break;
+						field = fieldEnd + 1;
+					}
+					for(size_t slot = 0; slot < columnCount && good; ++slot)
+					{
+						if(!found[slotOf[options.columns[slot]]])
+						{
+							CsvError error = {size_t(contentEnd - base), chunk.rows, slot, std::errc::invalid_argument};
+							chunk.errors.push_back(error);
+							good = false;
+						}
+					}
+					if(good)
+					{
+						for(size_t slot = 0; slot < columnCount; ++slot)
+							chunk.columns[slot].push_back(row[slotOf[options.columns[slot]]]);
+					}
+					++chunk.rows;
+					first = next;
+				}
+			}
+		}
+
+		// Parses delimited text into one DecimalColumn per loaded field. Fields follow Decimal(std::string)'s rules exactly.
+		// Rows with a bad or missing field are left out of every column and listed in errors, nothing throws.
+		// The buffer is split at line boundaries into chunks parsed on pool. Blank lines are skipped and "\r\n" is accepted.
+		inline CsvResult parse_csv(const char *first, const char *last, CsvOptions options = CsvOptions(), ThreadPool &pool = defaultThreadPool())
+		{
+			CsvResult result;
+			const char *base = first;
+			if(options.hasHeader)
+			{
+				const char *lineEnd = static_cast<const char*>(memchr(first, '\n', last - first));
+				first = lineEnd ? lineEnd + 1 : last;
+			}
+			if(options.columns.empty() && first != last)
+			{
+				const char *lineEnd = static_cast<const char*>(memchr(first, '\n', last - first));
+				const char *contentEnd = lineEnd ? lineEnd : last;
+				if(contentEnd != first && contentEnd[-1] == '\r')
+					--contentEnd;
+				for(size_t i = detail::countFields(first, contentEnd, options.delimiter); i > 0; --i)
+					options.columns.push_back(options.columns.size());
+			}
+			// a field listed more than once is parsed once and fills every slot listing it
+			std::vector<size_t> slotOf;
+			for(size_t slot = 0; slot < options.columns.size(); ++slot)
+			{
+				if(options.columns[slot] >= slotOf.size())
+					slotOf.resize(options.columns[slot] + 1, size_t(-1));
+				if(slotOf[options.columns[slot]] == size_t(-1))
+					slotOf[options.columns[slot]] = slot;
+			}
+
+			// chunk boundaries move forward to the next line start
+			const size_t minChunk = 1 << 16;
+			size_t size = last - first;
+			size_t chunkCount = std::max<size_t>(1, std::min(pool.size() * 4, size / minChunk));
+			std::vector<const char*> bounds(chunkCount + 1, last);
+			bounds[0] = first;
+			for(size_t c = 1; c < chunkCount; ++c)
+			{
+				const char *p = std::max(bounds[c - 1], first + size / chunkCount * c);
+				const char *lineEnd = static_cast<const char*>(memchr(p - 1, '\n', last - p + 1));
+				bounds[c] = lineEnd ? lineEnd + 1 : last;
+			}
+
+			std::vector<detail::CsvChunk> chunks(chunkCount);
+			pool.parallelFor(chunkCount, [&](size_t begin, size_t end)
+			{
+				for(size_t c = begin; c < end; ++c)
+					detail::parseCsvChunk(base, bounds[c], bounds[c + 1], last, options, slotOf, chunks[c]);
+			});
+
+			result.columns.assign(options.columns.size(), DecimalColumn());
+			for(detail::CsvChunk &chunk : chunks)
+			{
+				for(size_t slot = 0; slot < result.columns.size(); ++slot)
+					result.columns[slot].append(chunk.columns[slot]);
+				for(CsvError &error : chunk.errors)
+				{
+					error.row += result.rows;
+					result.errors.push_back(error);
+				}
+				result.rows += chunk.rows;
+			}
+			return result;
+		}
+
+		inline CsvResult load_csv(const std::string &path, const CsvOptions &options = CsvOptions(), ThreadPool &pool = defaultThreadPool())
+		{
+			MappedFile file(path);
+			return parse_csv(file.data(), file.data() + file.size(), options, pool);
+		}
+	}
+}
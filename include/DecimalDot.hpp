@@ -0,0 +1,369 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+#include "DecimalColumn.hpp"
+
+#include <algorithm>
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+#ifdef DECIMAL_X86_SIMD
+		namespace detail
+		{
+			// Adds the product of 32 bit halves x = x1:x0, y = y1:y0 into four 64 bit lanes per column of 32 bits.
+			// Every piece is below 2^32, so the lanes take millions of additions before they need folding.
+			__attribute__((target("avx512f")))
+			inline void mulColumnsAvx512(__m512i x, __m512i y, __m512i &c0, __m512i &c1, __m512i &c2, __m512i &c3)
+			{
+				const __m512i low32 = _mm512_set1_epi64(0xFFFFFFFF);
+				__m512i x1 = _mm512_srli_epi64(x, 32), y1 = _mm512_srli_epi64(y, 32);
+				__m512i p00 = _mm512_mul_epu32(x, y), p01 = _mm512_mul_epu32(x, y1);
+				__m512i p10 = _mm512_mul_epu32(x1, y), p11 = _mm512_mul_epu32(x1, y1);
+				c0 = _mm512_add_epi64(c0, _mm512_and_si512(p00, low32));
+				c1 = _mm512_add_epi64(c1, _mm512_add_epi64(_mm512_srli_epi64(p00, 32), _mm512_add_epi64(_mm512_and_si512(p01, low32), _mm512_and_si512(p10, low32))));
+				c2 = _mm512_add_epi64(c2, _mm512_add_epi64(_mm512_and_si512(p11, low32), _mm512_add_epi64(_mm512_srli_epi64(p01, 32), _mm512_srli_epi64(p10, 32))));
+				c3 = _mm512_add_epi64(c3, _mm512_srli_epi64(p11, 32));
+			}
+
+			// acc[k] += negative lanes ? -c[k] : c[k]
+			__attribute__((target("avx512f")))
+			inline void accumulateAvx512(__m512i *acc, const __m512i *c, __mmask8 negative)
+			{
+				for(int k = 0; k < 4; ++k)
+					acc[k] = _mm512_add_epi64(acc[k], _mm512_mask_sub_epi64(c[k], negative, _mm512_setzero_si512(), c[k]));
+			}
+
+			// Sums the wa*wb, wa*fb + fa*wb and fa*fb products of whole blocks of 8 from begin as signed 32 bit columns.
+			// Stops after 2^20 blocks to keep every lane far from overflow, returns where it stopped.
+			__attribute__((target("avx512f")))
+			inline size_t dotAvx512(ColumnView a, ColumnView b, size_t begin, size_t n, int64_t (&columns)[3][4])
+			{
+				__m512i acc[3][4];
+				for(int part = 0; part < 3; ++part)
+					for(int k = 0; k < 4; ++k)
+						acc[part][k] = _mm512_setzero_si512();
+				size_t end = begin + std::min<size_t>((n - begin) / 8, size_t(1) << 20) * 8;
+				for(size_t i = begin; i < end; i += 8)
+				{
+					__m512i wa = _mm512_loadu_si512(a.whole + i), fa = _mm512_loadu_si512(a.fraction + i);
+					__m512i wb = _mm512_loadu_si512(b.whole + i), fb = _mm512_loadu_si512(b.fraction + i);
+					__mmask8 negative = loadNegativeMask(a.negative + i) ^ loadNegativeMask(b.negative + i);
+					__m512i c[4];
+					for(int k = 0; k < 4; ++k)
+						c[k] = _mm512_setzero_si512();
+					mulColumnsAvx512(wa, wb, c[0], c[1], c[2], c[3]);
+					accumulateAvx512(acc[0], c, negative);
+					for(int k = 0; k < 4; ++k)
+						c[k] = _mm512_setzero_si512();
+					mulColumnsAvx512(wa, fb, c[0], c[1], c[2], c[3]);
+					mulColumnsAvx512(fa, wb, c[0], c[1], c[2], c[3]);
+					accumulateAvx512(acc[1], c, negative);
+					for(int k = 0; k < 4; ++k)
+						c[k] = _mm512_setzero_si512();
+					mulColumnsAvx512(fa, fb, c[0], c[1], c[2], c[3]);
+					accumulateAvx512(acc[2], c, negative);
+				}
+				for(int part = 0; part < 3; ++part)
+					for(int k = 0; k < 4; ++k)
+						columns[part][k] = _mm512_reduce_add_epi64(acc[part][k]);
+				return end;
+			}
+		}
+#endif
+
+		// Exact sum of Decimal products.
+		// a * b = wa*wb + (wa*fb + fa*wb) / 10^19 + fa*fb / 10^38. Each of the three parts is summed unnormalized in its own
+		// signed 192 bit total, so a product costs four 64x64 multiplies and carry adds, and is divided down once in result().
+		class DecimalDotAccumulator
+		{
+		public:
+			DecimalDotAccumulator() : sums_()
+			{ }
+
+			void add(const Decimal &a, const Decimal &b)
+			{
+				addProduct(sums_, a.positive_ != b.positive_, a.whole_, a.fraction_, b.whole_, b.fraction_);
+			}
+
+			// adds value itself, e.g. the addend of fma
+			void add(const Decimal &value)
+			{
+				addSigned(sums_.whole, !value.positive_, 0, value.whole_);
+				addSigned(sums_.middle, !value.positive_, 0, value.fraction_);
+			}
+
+			void add(const Decimal *a, const Decimal *b, size_t count)
+			{
+				Sum sums = sums_;
+				for(size_t i = 0; i < count; ++i)
+					addProduct(sums, a[i].positive_ != b[i].positive_, a[i].whole_, a[i].fraction_, b[i].whole_, b[i].fraction_);
+				sums_ = sums;
+			}
+
+			// throws std::invalid_argument for columns of different size
+			void add(const DecimalColumn &a, const DecimalColumn &b)
+			{
+				if(a.size() != b.size())
+					DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - column size mismatch"));
+				size_t i = 0;
+#ifdef DECIMAL_X86_SIMD
+				if(simdLevel() == SimdLevel::AVX512)
+				{
+					int64_t columns[3][4] = {};
+					for(size_t done; (done = detail::dotAvx512(a.view(), b.view(), i, a.size(), columns)) != i; i = done)
+					{
+						for(unsigned column = 0; column < 4; ++column)
+						{
+							addColumn(sums_.whole, columns[0][column], column);
+							addColumn(sums_.middle, columns[1][column], column);
+							addColumn(sums_.low, columns[2][column], column);
+						}
+					}
+				}
+#endif
+				const uint8_t *na = a.negative(), *nb = b.negative();
+				const uint64_t *wa = a.whole(), *fa = a.fraction(), *wb = b.whole(), *fb = b.fraction();
+				Sum sums = sums_;
+				for(; i < a.size(); ++i)
+					addProduct(sums, na[i] != nb[i], wa[i], fa[i], wb[i], fb[i]);
+				sums_ = sums;
+			}
+
+			void merge(const DecimalDotAccumulator &other)
+			{
+				addWide(sums_.whole, other.sums_.whole);
+				addWide(sums_.middle, other.sums_.middle);
+				addWide(sums_.low, other.sums_.low);
+			}
+
+			void clear()
+			{
+				sums_ = Sum();
+			}
+
+			// The exact total rounded once to 19 fraction digits. Truncate matches operator*'s rounding toward zero.
+			// Throws std::out_of_range when the total does not fit in a Decimal.
+			Decimal result(RoundingMode mode = RoundingMode::Truncate) const
+			{
+				// split every part into its side, then bring each side to whole + fraction / 10^19 + low / 10^38
+				Sum sides[2] = {};
+				split(sums_.whole, sides[0].whole, sides[1].whole);
+				split(sums_.middle, sides[0].middle, sides[1].middle);
+				split(sums_.low, sides[0].low, sides[1].low);
+				Normalized pos = normalize(sides[0]), neg = normalize(sides[1]);
+				bool negative = less(pos, neg);
+				if(negative)
+					std::swap(pos, neg);
+
+				// pos - neg, borrowing through the 10^-38 and 10^-19 digits
+				uint64_t borrow = pos.low < neg.low;
+				uint64_t low = pos.low - neg.low + (borrow ? fractionDenominator() : 0);
+				uint64_t subtrahend = neg.fraction + borrow;
+				borrow = pos.fraction < subtrahend;
+				uint64_t fraction = pos.fraction - subtrahend + (borrow ? fractionDenominator() : 0);
+				uint64_t whole[3] = {borrow, 0, 0};
+				negateWide(whole);
+				addWide(whole, pos.whole);
+				negateWide(neg.whole);
+				addWide(whole, neg.whole);
+
+				fraction += detail::roundingIncrement(fraction, low, fractionDenominator(), negative, mode);
+				if(fraction == fractionDenominator())
+				{
+					fraction = 0;
+					addSigned(whole, false, 0, 1);
+				}
+				if(whole[1] != 0 || whole[2] != 0)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - dot product is too large for Decimal"));
+
+				Decimal ret;
+				ret.whole_ = whole[0];
+				ret.fraction_ = fraction;
+				ret.positive_ = !negative || (ret.whole_ == 0 && ret.fraction_ == 0);
+				return ret;
+			}
+
+		private:
+			// 192 bit two's complement totals, least significant word first
+			struct Sum
+			{
+				uint64_t whole[3];  // wa*wb
+				uint64_t middle[3]; // wa*fb + fa*wb, units of 10^-19
+				uint64_t low[3];    // fa*fb, units of 10^-38
+			};
+
+			// one side's magnitude as whole + fraction / 10^19 + low / 10^38
+			struct Normalized
+			{
+				uint64_t whole[3];
+				uint64_t fraction;
+				uint64_t low;
+			};
+
+			static constexpr uint64_t fractionDenominator()
+			{
+				return Decimal::fractionDenominator_;
+			}
+
+			// sum += (negative ? -1 : 1) * x2:x1:x0, negation is ~x + 1 folded into the carry chain
+			static void addSigned(uint64_t *sum, bool negative, uint64_t x2, uint64_t x1, uint64_t x0)
+			{
+				uint64_t mask = 0 - uint64_t(negative);
+				x0 ^= mask;
+				x1 ^= mask;
+				uint64_t s0 = sum[0] + x0;
+				uint64_t carry = s0 < x0;
+				sum[0] = s0 + uint64_t(negative);
+				carry += sum[0] < s0;
+				uint64_t s1 = sum[1] + x1;
+				uint64_t carry1 = s1 < x1;
+				sum[1] = s1 + carry;
+				carry1 += sum[1] < s1;
+				sum[2] += (x2 ^ mask) + carry1;
+			}
+
+			static void addSigned(uint64_t *sum, bool negative, uint64_t hi, uint64_t lo)
+			{
+				addSigned(sum, negative, 0, hi, lo);
+			}
+
+			// sum += value * 2^(32 * column)
+			static void addColumn(uint64_t *sum, int64_t value, unsigned column)
+			{
+				bool negative = value < 0;
+				uint64_t mag = negative ? 0 - uint64_t(value) : uint64_t(value);
+				switch(column)
+				{
+				case 0: addSigned(sum, negative, 0, 0, mag); break;
+				case 1: addSigned(sum, negative, 0, mag >> 32, mag << 32); break;
+				case 2: addSigned(sum, negative, 0, mag, 0); break;
+				default: addSigned(sum, negative, mag >> 32, mag << 32, 0); break;
+				}
+			}
+
+			static void addWide(uint64_t *sum, const uint64_t *value)
+			{
+				uint64_t carry = 0;
+				for(int i = 0; i < 3; ++i)
+				{
+					uint64_t s = sum[i] + value[i];
+					uint64_t nextCarry = s < value[i];
+					sum[i] = s + carry;
+					carry = nextCarry | (sum[i] < s);
+				}
+			}
+
+			static void negateWide(uint64_t *value)
+			{
+				uint64_t carry = 1;
+				for(int i = 0; i < 3; ++i)
+				{
+					value[i] = ~value[i] + carry;
+					carry = carry && value[i] == 0;
+				}
+			}
+
+			static void split(const uint64_t *value, uint64_t *pos, uint64_t *neg)
+			{
+				bool negative = value[2] >> 63;
+				uint64_t *to = negative ? neg : pos;
+				for(int i = 0; i < 3; ++i)
+					to[i] = value[i];
+				if(negative)
+					negateWide(to);
+			}
+
+			// value = value / 10^19, returns the remainder
+			static uint64_t divideWide(uint64_t *value)
+			{
+				uint64_t rem = 0;
+				for(int i = 2; i >= 0; --i)
+					value[i] = detail::div128by64(rem, value[i], fractionDenominator(), rem);
+				return rem;
+			}
+
+			static Normalized normalize(Sum side)
+			{
+				Normalized ret;
+				ret.low = divideWide(side.low);
+				addWide(side.middle, side.low);
+				ret.fraction = divideWide(side.middle);
+				addWide(side.whole, side.middle);
+				for(int i = 0; i < 3; ++i)
+					ret.whole[i] = side.whole[i];
+				return ret;
+			}
+
+			static bool less(const Normalized &a, const Normalized &b)
+			{
+				for(int i = 2; i >= 0; --i)
+				{
+					if(a.whole[i] != b.whole[i])
+						return a.whole[i] < b.whole[i];
+				}
+				if(a.fraction != b.fraction)
+					return a.fraction < b.fraction;
+				return a.low < b.low;
+			}
+
+			static void addProduct(Sum &sums, bool negative, uint64_t wa, uint64_t fa, uint64_t wb, uint64_t fb)
+			{
+				uint64_t hi = 0, lo = 0;
+				lo = detail::mul64x64(wa, wb, hi);
+				addSigned(sums.whole, negative, hi, lo);
+				lo = detail::mul64x64(wa, fb, hi);
+				addSigned(sums.middle, negative, hi, lo);
+				lo = detail::mul64x64(fa, wb, hi);
+				addSigned(sums.middle, negative, hi, lo);
+				lo = detail::mul64x64(fa, fb, hi);
+				addSigned(sums.low, negative, hi, lo);
+			}
+
+			Sum sums_;
+		};
+
+		// sum of first1[i] * first2[i] rounded once, unlike adding up operator* results which truncates every product
+		template<typename InputIt1, typename InputIt2>
+		Decimal dot(InputIt1 first1, InputIt1 last1, InputIt2 first2, RoundingMode mode = RoundingMode::Truncate)
+		{
+			DecimalDotAccumulator acc;
+			for(; first1 != last1; ++first1, ++first2)
+				acc.add(*first1, *first2);
+			return acc.result(mode);
+		}
+
+		inline Decimal dot(const DecimalColumn &a, const DecimalColumn &b, RoundingMode mode = RoundingMode::Truncate)
+		{
+			DecimalDotAccumulator acc;
+			acc.add(a, b);
+			return acc.result(mode);
+		}
+
+		// a * b + c with a single rounding
+		inline Decimal fma(const Decimal &a, const Decimal &b, const Decimal &c, RoundingMode mode = RoundingMode::Truncate)
+		{
+			DecimalDotAccumulator acc;
+			acc.add(a, b);
+			acc.add(c);
+			return acc.result(mode);
+		}
+	}
+}
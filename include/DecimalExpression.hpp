@@ -0,0 +1,686 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include "Decimal.hpp"
+
+#include <type_traits>
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		namespace detail
+		{
+			// Fixed width unsigned integer, little endian 64 bit words
+			template<size_t Words>
+			struct WideUInt
+			{
+				uint64_t w[Words];
+			};
+
+			// denominator of an expression without division, multiplying by it is a no-op
+			struct NoDenominator
+			{ };
+
+			template<size_t Words>
+			struct Denominator
+			{
+				typedef WideUInt<Words> type;
+			};
+
+			template<>
+			struct Denominator<0>
+			{
+				typedef NoDenominator type;
+			};
+
+			template<size_t To, size_t From>
+			DECIMAL_CONSTEXPR WideUInt<To> wideWiden(const WideUInt<From> &a)
+			{
+				static_assert(To >= From, "wideWiden can not narrow");
+				WideUInt<To> r = {};
+				for(size_t i = 0; i < From; ++i)
+					r.w[i] = a.w[i];
+				return r;
+			}
+
+			template<size_t A, size_t B>
+			DECIMAL_CONSTEXPR WideUInt<A + B> wideMultiply(const WideUInt<A> &a, const WideUInt<B> &b)
+			{
+				WideUInt<A + B> r = {};
+				for(size_t i = 0; i < A; ++i)
+				{
+					if(a.w[i] == 0)
+						continue;
+					uint64_t carry = 0;
+					for(size_t j = 0; j < B; ++j)
+					{
+						uint64_t hi = 0, lo = mul64x64(a.w[i], b.w[j], hi);
+						lo += carry;
+						hi += (lo < carry);
+						r.w[i + j] += lo;
+						hi += (r.w[i + j] < lo);
+						carry = hi;
+					}
+					r.w[i + B] = carry;
+				}
+				return r;
+			}
+
+			template<size_t A>
+			DECIMAL_CONSTEXPR const WideUInt<A>& wideMultiply(const WideUInt<A> &a, NoDenominator)
+			{
+				return a;
+			}
+
+			template<size_t B>
+			DECIMAL_CONSTEXPR const WideUInt<B>& wideMultiply(NoDenominator, const WideUInt<B> &b)
+			{
+				return b;
+			}
+
+			DECIMAL_CONSTEXPR NoDenominator wideMultiply(NoDenominator, NoDenominator)
+			{
+				return NoDenominator();
+			}
+
+			// number of words up to the highest non zero one
+			template<size_t W>
+			DECIMAL_CONSTEXPR size_t wideUsed(const WideUInt<W> &a)
+			{
+				size_t used = W;
+				while(used > 0 && a.w[used - 1] == 0)
+					--used;
+				return used;
+			}
+
+			// a *= 10^(19 * count), a must have room for the result
+			template<size_t W>
+			DECIMAL_CONSTEXPR void wideScale(WideUInt<W> &a, unsigned count)
+			{
+				const constexpr uint64_t denominator = pow10Table[19];
+				size_t used = wideUsed(a);
+				for(; count > 0; --count)
+				{
+					uint64_t carry = 0;
+					for(size_t i = 0; i < used; ++i)
+					{
+						uint64_t hi = 0, lo = mul64x64(a.w[i], denominator, hi);
+						lo += carry;
+						hi += (lo < carry);
+						a.w[i] = lo;
+						carry = hi;
+					}
+					if(carry != 0)
+						a.w[used++] = carry;
+				}
+			}
+
+			template<size_t W>
+			DECIMAL_CONSTEXPR int wideCompare(const WideUInt<W> &a, const WideUInt<W> &b)
+			{
+				for(size_t i = W; i-- > 0;)
+					if(a.w[i] != b.w[i])
+						return a.w[i] < b.w[i] ? -1 : 1;
+				return 0;
+			}
+
+			template<size_t W>
+			DECIMAL_CONSTEXPR bool wideIsZero(const WideUInt<W> &a)
+			{
+				uint64_t bits = 0;
+				for(size_t i = 0; i < W; ++i)
+					bits |= a.w[i];
+				return bits == 0;
+			}
+
+			template<size_t W>
+			DECIMAL_CONSTEXPR void wideAdd(WideUInt<W> &a, const WideUInt<W> &b)
+			{
+				uint64_t carry = 0;
+				for(size_t i = 0; i < W; ++i)
+				{
+					uint64_t t = a.w[i] + carry;
+					carry = (t < carry);
+					a.w[i] = t + b.w[i];
+					carry |= (a.w[i] < t);
+				}
+			}
+
+			// a -= b, requires a >= b
+			template<size_t W>
+			DECIMAL_CONSTEXPR void wideSubtract(WideUInt<W> &a, const WideUInt<W> &b)
+			{
+				uint64_t borrow = 0;
+				for(size_t i = 0; i < W; ++i)
+				{
+					uint64_t t = a.w[i] - b.w[i];
+					uint64_t nextBorrow = (a.w[i] < b.w[i]);
+					a.w[i] = t - borrow;
+					borrow = nextBorrow | (t < borrow);
+				}
+			}
+
+			// sign magnitude a += (bNegative ? -b : b)
+			template<size_t W>
+			DECIMAL_CONSTEXPR void wideSignedAdd(bool &negative, WideUInt<W> &a, bool bNegative, const WideUInt<W> &b)
+			{
+				if(negative == bNegative)
+					wideAdd(a, b);
+				else if(wideCompare(a, b) >= 0)
+					wideSubtract(a, b);
+				else
+				{
+					WideUInt<W> t = b;
+					wideSubtract(t, a);
+					a = t;
+					negative = bNegative;
+				}
+			}
+
+			// q = n / d, r = n % d with Knuth's algorithm D, d must not be 0
+			template<size_t N, size_t D>
+			DECIMAL_CONSTEXPR void wideDivide(const WideUInt<N> &num, const WideUInt<D> &den, WideUInt<N> &q, WideUInt<D> &r)
+			{
+				size_t n = D, m = N;
+				while(n > 1 && den.w[n - 1] == 0)
+					--n;
+				while(m > 0 && num.w[m - 1] == 0)
+					--m;
+				q = WideUInt<N>();
+				r = WideUInt<D>();
+				if(m < n)
+				{
+					for(size_t i = 0; i < m; ++i)
+						r.w[i] = num.w[i];
+					return;
+				}
+				if(n == 1)
+				{
+					uint64_t rem = 0;
+					for(size_t i = m; i-- > 0;)
+						q.w[i] = div128by64(rem, num.w[i], den.w[0], rem);
+					r.w[0] = rem;
+					return;
+				}
+
+				// normalize so the divisor's top word has its top bit set
+				unsigned s = countLeadingZeros(den.w[n - 1]);
+				uint64_t v[D] = {}, u[N + 1] = {};
+				for(size_t i = 0; i < n; ++i)
+					v[i] = den.w[i] << s | (s && i ? den.w[i - 1] >> (64 - s) : 0);
+				for(size_t i = 0; i < m; ++i)
+					u[i] = num.w[i] << s | (s && i ? num.w[i - 1] >> (64 - s) : 0);
+				u[m] = s ? num.w[m - 1] >> (64 - s) : 0;
+
+				for(size_t j = m - n + 1; j-- > 0;)
+				{
+					// estimate from the top two words, at most 2 too large after the correction loop
+					uint64_t qhat = 0, rhat = 0;
+					bool rhatOverflow = false;
+					if(u[j + n] >= v[n - 1])
+					{
+						qhat = ~0ULL;
+						rhat = u[j + n - 1] + v[n - 1];
+						rhatOverflow = (rhat < v[n - 1]);
+					}
+					else
+						qhat = div128by64(u[j + n], u[j + n - 1], v[n - 1], rhat);
+					while(!rhatOverflow)
+					{
+						uint64_t pHi = 0, pLo = mul64x64(qhat, v[n - 2], pHi);
+						if(pHi < rhat || (pHi == rhat && pLo <= u[j + n - 2]))
+							break;
+						--qhat;
+						rhat += v[n - 1];
+						rhatOverflow = (rhat < v[n - 1]);
+					}
+
+					// u[j..j+n] -= qhat * v
+					uint64_t carry = 0, borrow = 0;
+					for(size_t i = 0; i < n; ++i)
+					{
+						uint64_t pHi = 0, pLo = mul64x64(qhat, v[i], pHi);
+						pLo += carry;
+						pHi += (pLo < carry);
+						carry = pHi;
+						uint64_t t = u[i + j] - pLo;
+						uint64_t nextBorrow = (u[i + j] < pLo);
+						u[i + j] = t - borrow;
+						borrow = nextBorrow | (t < borrow);
+					}
+					uint64_t t = u[j + n] - carry;
+					uint64_t negative = (u[j + n] < carry);
+					u[j + n] = t - borrow;
+					negative |= (t < borrow);
+					if(negative)
+					{
+						--qhat;
+						carry = 0;
+						for(size_t i = 0; i < n; ++i)
+						{
+							uint64_t sum = u[i + j] + carry;
+							carry = (sum < carry);
+							u[i + j] = sum + v[i];
+							carry |= (u[i + j] < sum);
+						}
+						u[j + n] += carry;
+					}
+					q.w[j] = qhat;
+				}
+				for(size_t i = 0; i < n; ++i)
+					r.w[i] = u[i] >> s | (s ? u[i + 1] << (64 - s) : 0);
+			}
+
+			// the remainder of a division as roundingIncrement's r with d == 4: 0 exact, 1 below half, 2 half, 3 above half
+			template<size_t W>
+			DECIMAL_CONSTEXPR uint64_t remainderClass(const WideUInt<W> &r, const WideUInt<W> &d)
+			{
+				if(wideIsZero(r))
+					return 0;
+				WideUInt<W> rest = d;
+				wideSubtract(rest, r);
+				return uint64_t(2 + wideCompare(r, rest));
+			}
+
+			// value = num / (den * 10^(19 * exponent)) where the exponent is a property of the expression type
+			template<size_t NumWords, size_t DenWords>
+			struct ExpressionValue
+			{
+				bool negative;
+				WideUInt<NumWords> num;
+				typename Denominator<DenWords>::type den;
+			};
+
+			struct ExpressionAccess
+			{
+				static DECIMAL_CONSTEXPR ExpressionValue<2, 0> value(const Decimal &value)
+				{
+					uint64_t hi = 0, lo = value.scaled(hi);
+					ExpressionValue<2, 0> ret = {value.negative(), {{lo, hi}}, NoDenominator()};
+					return ret;
+				}
+
+				static DECIMAL_CONSTEXPR Decimal make(bool negative, uint64_t whole, uint64_t fraction)
+				{
+					Decimal ret;
+					ret.whole_ = whole;
+					ret.fraction_ = fraction;
+					ret.positive_ = !negative || (whole == 0 && fraction == 0);
+					return ret;
+				}
+			};
+
+			// x * (den of the other operand) * 10^(19 * count) widened to W words
+			template<size_t W, size_t A, typename Den>
+			DECIMAL_CONSTEXPR WideUInt<W> alignTerm(const WideUInt<A> &x, const Den &den, unsigned count)
+			{
+				WideUInt<W> r = wideWiden<W>(wideMultiply(x, den));
+				wideScale(r, count);
+				return r;
+			}
+
+			// truncated q (scaled by 10^19) plus the rounding increment for the remainder class, as a Decimal.
+			// The whole part wraps modulo 2^64 like the operators.
+			template<size_t W>
+			DECIMAL_CONSTEXPR Decimal roundExpression(bool negative, WideUInt<W> q, uint64_t remainder, RoundingMode mode)
+			{
+				const constexpr uint64_t denominator = pow10Table[19];
+				const constexpr uint64_t reciprocal = reciprocalConstexpr(denominator);
+				uint64_t carry = roundingIncrement(q.w[0], remainder, 4, negative, mode);
+				for(size_t i = 0; i < W && carry; ++i)
+				{
+					q.w[i] += carry;
+					carry = (q.w[i] == 0);
+				}
+				uint64_t fraction = 0;
+				for(size_t i = wideUsed(q); i-- > 0;)
+					q.w[i] = div128by64Preinv(fraction, q.w[i], denominator, reciprocal, fraction);
+				return ExpressionAccess::make(negative, q.w[0], fraction);
+			}
+
+			// num / 10^(19 * (exponent - 1)) by repeated division with the precomputed reciprocal of 10^19
+			template<unsigned Exponent, size_t N>
+			DECIMAL_CONSTEXPR Decimal evaluateValue(const ExpressionValue<N, 0> &value, RoundingMode mode)
+			{
+				const constexpr uint64_t denominator = pow10Table[19];
+				const constexpr uint64_t reciprocal = reciprocalConstexpr(denominator);
+				WideUInt<N> q = value.num;
+				uint64_t rem = 0;
+				bool sticky = false;
+				for(unsigned k = 1; k < Exponent; ++k)
+				{
+					sticky |= (rem != 0);
+					rem = 0;
+					for(size_t i = wideUsed(q); i-- > 0;)
+						q.w[i] = div128by64Preinv(rem, q.w[i], denominator, reciprocal, rem);
+				}
+				uint64_t remainder = 0;
+				if(rem != 0 || sticky)
+				{
+					uint64_t rest = denominator - rem;
+					remainder = rem < rest ? 1 : (rem > rest || sticky ? 3 : 2);
+				}
+				return roundExpression(value.negative, q, remainder, mode);
+			}
+
+			template<unsigned Exponent, size_t N, size_t D>
+			DECIMAL_CONSTEXPR Decimal evaluateValue(const ExpressionValue<N, D> &value, RoundingMode mode)
+			{
+				WideUInt<D + Exponent - 1> den = wideWiden<D + Exponent - 1>(value.den);
+				wideScale(den, Exponent - 1);
+				WideUInt<N> q = {};
+				WideUInt<D + Exponent - 1> r = {};
+				wideDivide(value.num, den, q, r);
+				return roundExpression(value.negative, q, remainderClass(r, den), mode);
+			}
+		}
+
+		// Base of the lazy expression types. Evaluated exactly with wide integers and rounded once,
+		// on conversion to Decimal (Truncate like the operators) or by evaluate(mode).
+		// A single operation gives the same Decimal as the operator, including whole part wrap around.
+		// Throws std::runtime_error on division by zero.
+		// With DECIMAL_INSTRUMENTATION each node counts its operation when evaluated, not when built.
+		// Constexpr on the native backend, so Decimal arithmetic stays constexpr with DECIMAL_EXPRESSION_TEMPLATES.
+		// With boost::multiprecision the wide integer helpers are not, and in that mode + and - lose constexpr too.
+		template<typename Derived>
+		class DecimalExpression
+		{
+		public:
+			DECIMAL_CONSTEXPR Decimal evaluate(RoundingMode mode = RoundingMode::Truncate) const
+			{
+				return detail::evaluateValue<Derived::EXPONENT>(static_cast<const Derived&>(*this).value(), mode);
+			}
+
+			DECIMAL_CONSTEXPR operator Decimal() const
+			{
+				return evaluate();
+			}
+		};
+
+		namespace detail
+		{
+			class ExpressionLeaf : public DecimalExpression<ExpressionLeaf>
+			{
+			public:
+				static const constexpr size_t NUM_WORDS = 2;
+				static const constexpr size_t DEN_WORDS = 0;
+				static const constexpr unsigned EXPONENT = 1;
+
+				explicit DECIMAL_CONSTEXPR ExpressionLeaf(const Decimal &value) : value_(value)
+				{ }
+
+				DECIMAL_CONSTEXPR ExpressionValue<NUM_WORDS, DEN_WORDS> value() const
+				{
+					return ExpressionAccess::value(value_);
+				}
+
+			private:
+				Decimal value_;
+			};
+
+			constexpr size_t maxOf(size_t a, size_t b)
+			{
+				return a > b ? a : b;
+			}
+
+			template<typename L, typename R, bool Subtract>
+			class ExpressionSum : public DecimalExpression<ExpressionSum<L, R, Subtract>>
+			{
+			public:
+				static const constexpr unsigned EXPONENT = L::EXPONENT > R::EXPONENT ? L::EXPONENT : R::EXPONENT;
+				static const constexpr size_t DEN_WORDS = L::DEN_WORDS + R::DEN_WORDS;
+				static const constexpr size_t NUM_WORDS = maxOf(L::NUM_WORDS + R::DEN_WORDS + (EXPONENT - L::EXPONENT), R::NUM_WORDS + L::DEN_WORDS + (EXPONENT - R::EXPONENT)) + 1;
+
+				DECIMAL_CONSTEXPR ExpressionSum(const L &left, const R &right) : left_(left), right_(right)
+				{ }
+
+				DECIMAL_CONSTEXPR ExpressionValue<NUM_WORDS, DEN_WORDS> value() const
+				{
+					if(Subtract)
+						DECIMAL_COUNT(Subtract);
+					else
+						DECIMAL_COUNT(Add);
+					auto a = left_.value();
+					auto b = right_.value();
+					ExpressionValue<NUM_WORDS, DEN_WORDS> ret = {a.negative, alignTerm<NUM_WORDS>(a.num, b.den, EXPONENT - L::EXPONENT), wideMultiply(a.den, b.den)};
+					wideSignedAdd(ret.negative, ret.num, b.negative != Subtract, alignTerm<NUM_WORDS>(b.num, a.den, EXPONENT - R::EXPONENT));
+					return ret;
+				}
+
+			private:
+				L left_;
+				R right_;
+			};
+
+			template<typename L, typename R>
+			class ExpressionProduct : public DecimalExpression<ExpressionProduct<L, R>>
+			{
+			public:
+				static const constexpr unsigned EXPONENT = L::EXPONENT + R::EXPONENT;
+				static const constexpr size_t DEN_WORDS = L::DEN_WORDS + R::DEN_WORDS;
+				static const constexpr size_t NUM_WORDS = L::NUM_WORDS + R::NUM_WORDS;
+
+				DECIMAL_CONSTEXPR ExpressionProduct(const L &left, const R &right) : left_(left), right_(right)
+				{ }
+
+				DECIMAL_CONSTEXPR ExpressionValue<NUM_WORDS, DEN_WORDS> value() const
+				{
+					DECIMAL_COUNT(Multiply);
+					auto a = left_.value();
+					auto b = right_.value();
+					ExpressionValue<NUM_WORDS, DEN_WORDS> ret = {a.negative != b.negative, wideMultiply(a.num, b.num), wideMultiply(a.den, b.den)};
+					return ret;
+				}
+
+			private:
+				L left_;
+				R right_;
+			};
+
+			// (na / (da * 10^ea)) / (nb / (db * 10^eb)) == (na * db * 10^eb) / (da * nb * 10^ea)
+			template<typename L, typename R>
+			class ExpressionQuotient : public DecimalExpression<ExpressionQuotient<L, R>>
+			{
+			public:
+				static const constexpr unsigned EXPONENT = L::EXPONENT;
+				static const constexpr size_t DEN_WORDS = L::DEN_WORDS + R::NUM_WORDS;
+				static const constexpr size_t NUM_WORDS = L::NUM_WORDS + R::DEN_WORDS + R::EXPONENT;
+
+				DECIMAL_CONSTEXPR ExpressionQuotient(const L &left, const R &right) : left_(left), right_(right)
+				{ }
+
+				DECIMAL_CONSTEXPR ExpressionValue<NUM_WORDS, DEN_WORDS> value() const
+				{
+					DECIMAL_COUNT(Divide);
+					auto a = left_.value();
+					auto b = right_.value();
+					if(wideIsZero(b.num))
+						DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero"));
+					ExpressionValue<NUM_WORDS, DEN_WORDS> ret = {a.negative != b.negative, alignTerm<NUM_WORDS>(a.num, b.den, R::EXPONENT), wideMultiply(a.den, b.num)};
+					return ret;
+				}
+
+			private:
+				L left_;
+				R right_;
+			};
+
+			template<typename E>
+			class ExpressionNegate : public DecimalExpression<ExpressionNegate<E>>
+			{
+			public:
+				static const constexpr unsigned EXPONENT = E::EXPONENT;
+				static const constexpr size_t DEN_WORDS = E::DEN_WORDS;
+				static const constexpr size_t NUM_WORDS = E::NUM_WORDS;
+
+				explicit DECIMAL_CONSTEXPR ExpressionNegate(const E &expression) : expression_(expression)
+				{ }
+
+				DECIMAL_CONSTEXPR ExpressionValue<NUM_WORDS, DEN_WORDS> value() const
+				{
+					ExpressionValue<NUM_WORDS, DEN_WORDS> ret = expression_.value();
+					ret.negative = !ret.negative;
+					return ret;
+				}
+
+			private:
+				E expression_;
+			};
+
+			template<typename T>
+			struct IsExpression
+			{
+				static const constexpr bool value = std::is_base_of<DecimalExpression<T>, T>::value;
+			};
+
+			// Decimals and built in numbers become leaves, expressions are used as they are
+			template<typename T, typename Enable = void>
+			struct ExpressionOperand
+			{
+				static const constexpr bool valid = false;
+				static const constexpr bool leaf = false;
+			};
+
+			template<typename T>
+			struct ExpressionOperand<T, typename std::enable_if<IsExpression<T>::value>::type>
+			{
+				static const constexpr bool valid = true;
+				static const constexpr bool leaf = false;
+				typedef T type;
+				static DECIMAL_CONSTEXPR const T& make(const T &value)
+				{
+					return value;
+				}
+			};
+
+			template<typename T>
+			struct ExpressionOperand<T, typename std::enable_if<std::is_same<T, Decimal>::value || std::is_arithmetic<T>::value>::type>
+			{
+				static const constexpr bool valid = true;
+				static const constexpr bool leaf = true;
+				typedef ExpressionLeaf type;
+				static DECIMAL_CONSTEXPR ExpressionLeaf make(const T &value)
+				{
+					// integers of any width go through the int64_t or uint64_t constructor
+					typedef typename std::conditional<IsInteger<T>::value, IntegerOperand<T>, T>::type Converted;
+					return ExpressionLeaf(Decimal(static_cast<Converted>(value)));
+				}
+			};
+
+			// Operators apply when one side is an expression. With DECIMAL_EXPRESSION_TEMPLATES defined they also
+			// replace Decimal's own binary operators, so Decimal op Decimal/number builds an expression too.
+			template<typename L, typename R>
+			struct ExpressionOperator
+			{
+				static const constexpr bool value = ExpressionOperand<L>::valid && ExpressionOperand<R>::valid
+#ifdef DECIMAL_EXPRESSION_TEMPLATES
+					&& (!ExpressionOperand<L>::leaf || !ExpressionOperand<R>::leaf || std::is_same<L, Decimal>::value || std::is_same<R, Decimal>::value);
+#else
+					&& (!ExpressionOperand<L>::leaf || !ExpressionOperand<R>::leaf);
+#endif
+			};
+		}
+
+		// starts an expression without DECIMAL_EXPRESSION_TEMPLATES: Decimal r = lazy(price) * qty + fee - rebate;
+		DECIMAL_CONSTEXPR detail::ExpressionLeaf lazy(const Decimal &value)
+		{
+			return detail::ExpressionLeaf(value);
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value, int>::type = 0>
+		DECIMAL_CONSTEXPR detail::ExpressionSum<typename detail::ExpressionOperand<L>::type, typename detail::ExpressionOperand<R>::type, false> operator+(const L &lhs, const R &rhs)
+		{
+			return {detail::ExpressionOperand<L>::make(lhs), detail::ExpressionOperand<R>::make(rhs)};
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value, int>::type = 0>
+		DECIMAL_CONSTEXPR detail::ExpressionSum<typename detail::ExpressionOperand<L>::type, typename detail::ExpressionOperand<R>::type, true> operator-(const L &lhs, const R &rhs)
+		{
+			return {detail::ExpressionOperand<L>::make(lhs), detail::ExpressionOperand<R>::make(rhs)};
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value, int>::type = 0>
+		DECIMAL_CONSTEXPR detail::ExpressionProduct<typename detail::ExpressionOperand<L>::type, typename detail::ExpressionOperand<R>::type> operator*(const L &lhs, const R &rhs)
+		{
+			return {detail::ExpressionOperand<L>::make(lhs), detail::ExpressionOperand<R>::make(rhs)};
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value, int>::type = 0>
+		DECIMAL_CONSTEXPR detail::ExpressionQuotient<typename detail::ExpressionOperand<L>::type, typename detail::ExpressionOperand<R>::type> operator/(const L &lhs, const R &rhs)
+		{
+			return {detail::ExpressionOperand<L>::make(lhs), detail::ExpressionOperand<R>::make(rhs)};
+		}
+
+		template<typename E>
+		DECIMAL_CONSTEXPR detail::ExpressionNegate<E> operator-(const DecimalExpression<E> &expression)
+		{
+			return detail::ExpressionNegate<E>(static_cast<const E&>(expression));
+		}
+
+		// Comparisons involving an expression compare the Decimals it evaluates to
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value && (detail::IsExpression<L>::value || detail::IsExpression<R>::value), int>::type = 0>
+		DECIMAL_CONSTEXPR bool operator==(const L &lhs, const R &rhs)
+		{
+			return Decimal(lhs) == Decimal(rhs);
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value && (detail::IsExpression<L>::value || detail::IsExpression<R>::value), int>::type = 0>
+		DECIMAL_CONSTEXPR bool operator!=(const L &lhs, const R &rhs)
+		{
+			return Decimal(lhs) != Decimal(rhs);
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value && (detail::IsExpression<L>::value || detail::IsExpression<R>::value), int>::type = 0>
+		DECIMAL_CONSTEXPR bool operator<(const L &lhs, const R &rhs)
+		{
+			return Decimal(lhs) < Decimal(rhs);
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value && (detail::IsExpression<L>::value || detail::IsExpression<R>::value), int>::type = 0>
+		DECIMAL_CONSTEXPR bool operator<=(const L &lhs, const R &rhs)
+		{
+			return Decimal(lhs) <= Decimal(rhs);
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value && (detail::IsExpression<L>::value || detail::IsExpression<R>::value), int>::type = 0>
+		DECIMAL_CONSTEXPR bool operator>(const L &lhs, const R &rhs)
+		{
+			return Decimal(lhs) > Decimal(rhs);
+		}
+
+		template<typename L, typename R, typename std::enable_if<detail::ExpressionOperator<L, R>::value && (detail::IsExpression<L>::value || detail::IsExpression<R>::value), int>::type = 0>
+		DECIMAL_CONSTEXPR bool operator>=(const L &lhs, const R &rhs)
+		{
+			return Decimal(lhs) >= Decimal(rhs);
+		}
+
+		// decimal_cast of an expression converts the Decimal it evaluates to, like decimal_cast<To>(Decimal(expression), mode)
+		template<typename To, typename E>
+		DECIMAL_CONSTEXPR To decimal_cast(const DecimalExpression<E> &expression, RoundingMode mode = RoundingMode::Truncate)
+		{
+			return To(expression.evaluate(), mode);
+		}
+
+		template<typename E>
+		inline std::ostream& operator<<(std::ostream &os, const DecimalExpression<E> &expression)
+		{
+			return os << expression.evaluate();
+		}
+	}
+}
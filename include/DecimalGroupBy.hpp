@@ -0,0 +1,179 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "Decimal.hpp"
+#include "DecimalAccumulator.hpp"
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		// Groups rows by a Decimal key keeping an exact running sum and a row count per group, e.g. volume per price level for VWAP.
+		// Groups are stored densely in first seen order. A flat open addressing index (linear probing, power of two size,
+		// at most half full) maps keys to them; each 8 byte slot holds the top 32 bits of the key's hash and the group number
+		// so most probes never touch a key. -0 and 0 are the same group.
+		class DecimalGroupBy
+		{
+		public:
+			struct Group
+			{
+				Decimal key;
+				DecimalAccumulator sum;
+				uint64_t count;
+			};
+
+			typedef std::vector<Group>::const_iterator const_iterator;
+
+			DecimalGroupBy() : mask_(0)
+			{ }
+
+			explicit DecimalGroupBy(size_t expectedGroups) : mask_(0)
+			{
+				reserve(expectedGroups);
+			}
+
+			void add(const Decimal &key, const Decimal &value)
+			{
+				Group &group = findOrInsert(key);
+				group.sum.add(value);
+				++group.count;
+			}
+
+			void add(const Decimal *keys, const Decimal *values, size_t count)
+			{
+				for(size_t i = 0; i < count; ++i)
+					add(keys[i], values[i]);
+			}
+
+			// adds other's sums and counts, e.g. to combine per thread tables
+			void merge(const DecimalGroupBy &other)
+			{
+				for(const Group &from : other.groups_)
+				{
+					Group &group = findOrInsert(from.key);
+					group.sum.merge(from.sum);
+					group.count += from.count;
+				}
+			}
+
+			// nullptr if no row had this key
+			const Group* find(const Decimal &key) const
+			{
+				if(groups_.empty())
+					return nullptr;
+				const uint64_t hash = detail::DecimalHash::hash(key);
+				for(size_t pos = hash & mask_; slots_[pos] != 0; pos = (pos + 1) & mask_)
+				{
+					if((slots_[pos] & TAG_MASK) == (hash & TAG_MASK))
+					{
+						const Group &group = groups_[(slots_[pos] & INDEX_MASK) - 1];
+						if(detail::DecimalHash::equal(group.key, key))
+							return &group;
+					}
+				}
+				return nullptr;
+			}
+
+			void reserve(size_t expectedGroups)
+			{
+				groups_.reserve(expectedGroups);
+				size_t slots = slots_.empty() ? MIN_SLOTS : slots_.size();
+				while(slots < expectedGroups * 2)
+					slots *= 2;
+				if(slots != slots_.size())
+					rehash(slots);
+			}
+
+			void clear()
+			{
+				groups_.clear();
+				std::fill(slots_.begin(), slots_.end(), 0);
+			}
+
+			size_t size() const
+			{
+				return groups_.size();
+			}
+
+			bool empty() const
+			{
+				return groups_.empty();
+			}
+
+			const_iterator begin() const
+			{
+				return groups_.begin();
+			}
+
+			const_iterator end() const
+			{
+				return groups_.end();
+			}
+
+		private:
+			static const constexpr uint64_t TAG_MASK = 0xFFFFFFFF00000000ULL;
+			static const constexpr uint64_t INDEX_MASK = 0x00000000FFFFFFFFULL;
+			static const constexpr size_t MIN_SLOTS = 16;
+
+			Group& findOrInsert(const Decimal &key)
+			{
+				if(groups_.size() * 2 >= slots_.size())
+					rehash(slots_.empty() ? MIN_SLOTS : slots_.size() * 2);
+
+				const uint64_t hash = detail::DecimalHash::hash(key);
+				size_t pos = hash & mask_;
+				for(; slots_[pos] != 0; pos = (pos + 1) & mask_)
+				{
+					if((slots_[pos] & TAG_MASK) == (hash & TAG_MASK))
+					{
+						Group &group = groups_[(slots_[pos] & INDEX_MASK) - 1];
+						if(detail::DecimalHash::equal(group.key, key))
+							return group;
+					}
+				}
+
+				if(groups_.size() >= INDEX_MASK)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - too many groups for DecimalGroupBy"));
+				slots_[pos] = (hash & TAG_MASK) | (groups_.size() + 1);
+				groups_.push_back(Group{key, DecimalAccumulator(), 0});
+				return groups_.back();
+			}
+
+			void rehash(size_t slots)
+			{
+				slots_.assign(slots, 0);
+				mask_ = slots - 1;
+				for(size_t i = 0; i < groups_.size(); ++i)
+				{
+					const uint64_t hash = detail::DecimalHash::hash(groups_[i].key);
+					size_t pos = hash & mask_;
+					while(slots_[pos] != 0)
+						pos = (pos + 1) & mask_;
+					slots_[pos] = (hash & TAG_MASK) | (i + 1);
+				}
+			}
+
+			std::vector<Group> groups_;
+			std::vector<uint64_t> slots_;
+			size_t mask_;
+		};
+	}
+}
@@ -0,0 +1,245 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+
+// Per thread operation counters for Decimal. Define DECIMAL_INSTRUMENTATION (for every translation unit) to have
+// Decimal.hpp count its operations here, otherwise DECIMAL_COUNT compiles to nothing and every count stays 0.
+// Counting is skipped during constant evaluation, so instrumenting needs __builtin_is_constant_evaluated (gcc 9, clang 9).
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		enum class DecimalCounter : uint8_t
+		{
+			Add,                   // operator+= and +, including the calls below made internally
+			Subtract,              // operator-= and -
+			AddSubtractSlowPath,   // += / -= branches that negate or swap operands and call back into -= / +=
+			Multiply,
+			Divide,                // operator/= and / by a Decimal or an integer
+			WideDivide,            // divisors of 1.8446744073709551616 (2^64 scaled) or more, the 192 by 128 bit path
+			Compare,
+			Parse,                 // string and char* constructors, from_chars
+			Format,                // to_chars, to_string, operator<<
+			FormatAllocation,      // to_string results too long for std::string's small buffer (parsing never allocates)
+			FromBinary,            // float, double and long double constructors
+			ToBinary,              // to_double, to_float, asDouble
+			StreamIn,              // values read by operator>> and read_decimals
+			StreamOut,
+			Exception              // exceptions thrown by the library headers
+		};
+
+		enum class CounterFormat
+		{
+			Text,
+			Json
+		};
+
+		// a snapshot of every counter
+		struct DecimalCounters
+		{
+			static const constexpr size_t SIZE = static_cast<size_t>(DecimalCounter::Exception) + 1;
+
+			uint64_t operator[](DecimalCounter counter) const
+			{
+				return counts[static_cast<size_t>(counter)];
+			}
+
+			uint64_t counts[SIZE];
+		};
+
+		inline const char* decimal_counter_name(DecimalCounter counter)
+		{
+			static const char *const names[DecimalCounters::SIZE] = {"add", "subtract", "add_subtract_slow_path", "multiply", "divide", "wide_divide",
+				"compare", "parse", "format", "format_allocation", "from_binary", "to_binary", "stream_in", "stream_out", "exception"};
+			return names[static_cast<size_t>(counter)];
+		}
+
+		namespace detail
+		{
+			// Each thread only ever increments its own counters (a relaxed load and store, no locked instruction).
+			// Live threads register here; a finishing thread folds its counts into retired_. Reset records a baseline
+			// instead of zeroing, so it never races with the increments.
+			class CounterRegistry
+			{
+			public:
+				struct ThreadCounters
+				{
+					ThreadCounters()
+					{
+						for(std::atomic<uint64_t> &count : counts)
+							count.store(0, std::memory_order_relaxed);
+						instance().attach(this);
+					}
+
+					~ThreadCounters()
+					{
+						instance().detach(this);
+					}
+
+					std::atomic<uint64_t> counts[DecimalCounters::SIZE];
+				};
+
+				static CounterRegistry& instance()
+				{
+					static CounterRegistry registry;
+					return registry;
+				}
+
+				static ThreadCounters& local()
+				{
+					static thread_local ThreadCounters counters;
+					return counters;
+				}
+
+				DecimalCounters snapshot()
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					DecimalCounters ret = totals();
+					for(size_t i = 0; i < DecimalCounters::SIZE; ++i)
+						ret.counts[i] -= baseline_[i];
+					return ret;
+				}
+
+				void reset()
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					DecimalCounters now = totals();
+					for(size_t i = 0; i < DecimalCounters::SIZE; ++i)
+						baseline_[i] = now.counts[i];
+				}
+
+			private:
+				CounterRegistry() : retired_(), baseline_()
+				{ }
+
+				void attach(ThreadCounters *counters)
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					threads_.push_back(counters);
+				}
+
+				void detach(ThreadCounters *counters)
+				{
+					std::lock_guard<std::mutex> lock(mutex_);
+					for(size_t i = 0; i < DecimalCounters::SIZE; ++i)
+						retired_[i] += counters->counts[i].load(std::memory_order_relaxed);
+					for(size_t i = 0; i < threads_.size(); ++i)
+					{
+						if(threads_[i] == counters)
+						{
+							threads_[i] = threads_.back();
+							threads_.pop_back();
+							break;
+						}
+					}
+				}
+
+				// requires mutex_
+				DecimalCounters totals() const
+				{
+					DecimalCounters ret;
+					for(size_t i = 0; i < DecimalCounters::SIZE; ++i)
+						ret.counts[i] = retired_[i];
+					for(const ThreadCounters *counters : threads_)
+					{
+						for(size_t i = 0; i < DecimalCounters::SIZE; ++i)
+							ret.counts[i] += counters->counts[i].load(std::memory_order_relaxed);
+					}
+					return ret;
+				}
+
+				std::mutex mutex_;
+				std::vector<ThreadCounters*> threads_;
+				uint64_t retired_[DecimalCounters::SIZE];
+				uint64_t baseline_[DecimalCounters::SIZE];
+			};
+
+			inline void countDecimal(DecimalCounter counter)
+			{
+				std::atomic<uint64_t> &count = CounterRegistry::local().counts[static_cast<size_t>(counter)];
+				count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			}
+
+			template<typename Exception>
+			const Exception& countException(const Exception &e)
+			{
+				countDecimal(DecimalCounter::Exception);
+				return e;
+			}
+		}
+
+		// totals over every thread since the last reset_decimal_counters()
+		inline DecimalCounters decimal_counters()
+		{
+			return detail::CounterRegistry::instance().snapshot();
+		}
+
+		// the calling thread's counts since it started, reset_decimal_counters() does not change them
+		inline DecimalCounters thread_decimal_counters()
+		{
+			DecimalCounters ret;
+			for(size_t i = 0; i < DecimalCounters::SIZE; ++i)
+				ret.counts[i] = detail::CounterRegistry::local().counts[i].load(std::memory_order_relaxed);
+			return ret;
+		}
+
+		inline void reset_decimal_counters()
+		{
+			detail::CounterRegistry::instance().reset();
+		}
+
+		// Text is one "name count" line per counter, Json a single object of name: count
+		inline void write_decimal_counters(std::ostream &os, const DecimalCounters &counters, CounterFormat format = CounterFormat::Text)
+		{
+			if(format == CounterFormat::Json)
+				os << '{';
+			for(size_t i = 0; i < DecimalCounters::SIZE; ++i)
+			{
+				const char *name = decimal_counter_name(static_cast<DecimalCounter>(i));
+				if(format == CounterFormat::Json)
+					os << (i == 0 ? "" : ", ") << '"' << name << "\": " << counters.counts[i];
+				else
+				{
+					os << name;
+					for(size_t pad = std::char_traits<char>::length(name); pad < 24; ++pad)
+						os << ' ';
+					os << counters.counts[i] << '\n';
+				}
+			}
+			if(format == CounterFormat::Json)
+				os << "}\n";
+		}
+	}
+}
+
+#ifdef DECIMAL_INSTRUMENTATION
+#if !defined(__has_builtin)
+#error "DECIMAL_INSTRUMENTATION needs __builtin_is_constant_evaluated"
+#elif !__has_builtin(__builtin_is_constant_evaluated)
+#error "DECIMAL_INSTRUMENTATION needs __builtin_is_constant_evaluated"
+#endif
+#define DECIMAL_COUNT(counter) (__builtin_is_constant_evaluated() ? void() : ::tylawin::DataTypes::detail::countDecimal(::tylawin::DataTypes::DecimalCounter::counter))
+#define DECIMAL_THROW(exception) throw ::tylawin::DataTypes::detail::countException(exception)
+#endif
@@ -0,0 +1,561 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include <cmath>
+
+#include "DecimalExpression.hpp"
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		namespace detail
+		{
+			// Unsigned binary fixed point with the whole part in w[3] and 192 fraction bits in w[0..2].
+			// Each step truncates below 2^-192, far under the 10^-19 resolution of the result.
+			typedef WideUInt<4> Fixed;
+
+			// ln(2) and 1 / ln(2)
+			const constexpr Fixed fixedLn2 = {{0x40f343267298b62eULL, 0xc9e3b39803f2f6afULL, 0xb17217f7d1cf79abULL, 0x0000000000000000ULL}};
+			const constexpr Fixed fixedInverseLn2 = {{0xd6aef551bad2b4b1ULL, 0x7d0ffda0d23a7d11ULL, 0x71547652b82fe177ULL, 0x0000000000000001ULL}};
+
+			// 1 / n! for the exp series
+			const constexpr Fixed fixedInverseFactorial[13] =
+			{
+				{{0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000001ULL}},
+				{{0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000001ULL}},
+				{{0x0000000000000000ULL, 0x0000000000000000ULL, 0x8000000000000000ULL, 0x0000000000000000ULL}},
+				{{0xaaaaaaaaaaaaaaabULL, 0xaaaaaaaaaaaaaaaaULL, 0x2aaaaaaaaaaaaaaaULL, 0x0000000000000000ULL}},
+				{{0xaaaaaaaaaaaaaaabULL, 0xaaaaaaaaaaaaaaaaULL, 0x0aaaaaaaaaaaaaaaULL, 0x0000000000000000ULL}},
+				{{0x2222222222222222ULL, 0x2222222222222222ULL, 0x0222222222222222ULL, 0x0000000000000000ULL}},
+				{{0x5b05b05b05b05b06ULL, 0x05b05b05b05b05b0ULL, 0x005b05b05b05b05bULL, 0x0000000000000000ULL}},
+				{{0x0d00d00d00d00d01ULL, 0x00d00d00d00d00d0ULL, 0x000d00d00d00d00dULL, 0x0000000000000000ULL}},
+				{{0x01a01a01a01a01a0ULL, 0xa01a01a01a01a01aULL, 0x0001a01a01a01a01ULL, 0x0000000000000000ULL}},
+				{{0xe3bc74aad8e671f5ULL, 0x671f5583911ca002ULL, 0x00002e3bc74aad8eULL, 0x0000000000000000ULL}},
+				{{0xe392d8777c170b65ULL, 0xd71cbbc05b4fa999ULL, 0x0000049f93edde27ULL, 0x0000000000000000ULL}},
+				{{0x71c7880adcbc46dbULL, 0x138e3f9d1f92e0dfULL, 0x0000006b99159fd5ULL, 0x0000000000000000ULL}},
+				{{0xf425f600e7ba5b3dULL, 0x6c4bdaa26d4c3d67ULL, 0x00000008f76c77fcULL, 0x0000000000000000ULL}}
+			};
+
+			// 1 / (2n + 1) for the atanh series
+			const constexpr Fixed fixedInverseOdd[12] =
+			{
+				{{0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000001ULL}},
+				{{0x5555555555555555ULL, 0x5555555555555555ULL, 0x5555555555555555ULL, 0x0000000000000000ULL}},
+				{{0x3333333333333333ULL, 0x3333333333333333ULL, 0x3333333333333333ULL, 0x0000000000000000ULL}},
+				{{0x9249249249249249ULL, 0x4924924924924924ULL, 0x2492492492492492ULL, 0x0000000000000000ULL}},
+				{{0x71c71c71c71c71c7ULL, 0xc71c71c71c71c71cULL, 0x1c71c71c71c71c71ULL, 0x0000000000000000ULL}},
+				{{0x45d1745d1745d174ULL, 0x745d1745d1745d17ULL, 0x1745d1745d1745d1ULL, 0x0000000000000000ULL}},
+				{{0xb13b13b13b13b13bULL, 0x3b13b13b13b13b13ULL, 0x13b13b13b13b13b1ULL, 0x0000000000000000ULL}},
+				{{0x1111111111111111ULL, 0x1111111111111111ULL, 0x1111111111111111ULL, 0x0000000000000000ULL}},
+				{{0x0f0f0f0f0f0f0f0fULL, 0x0f0f0f0f0f0f0f0fULL, 0x0f0f0f0f0f0f0f0fULL, 0x0000000000000000ULL}},
+				{{0x35e50d79435e50d8ULL, 0xe50d79435e50d794ULL, 0x0d79435e50d79435ULL, 0x0000000000000000ULL}},
+				{{0x30c30c30c30c30c3ULL, 0xc30c30c30c30c30cULL, 0x0c30c30c30c30c30ULL, 0x0000000000000000ULL}},
+				{{0x90b21642c8590b21ULL, 0x42c8590b21642c85ULL, 0x0b21642c8590b216ULL, 0x0000000000000000ULL}}
+			};
+
+			// r_j = 32 / (32 + j) rounded up and -ln(r_j) of the rounded value, m * r_j is in [1, 1 + 1/32) for m in [1 + j/32, 1 + (j + 1)/32)
+			const constexpr Fixed fixedLogReduction[32] =
+			{
+				{{0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000001ULL}},
+				{{0x3e0f83e0f83e0f84ULL, 0x83e0f83e0f83e0f8ULL, 0xf83e0f83e0f83e0fULL, 0x0000000000000000ULL}},
+				{{0xf0f0f0f0f0f0f0f1ULL, 0xf0f0f0f0f0f0f0f0ULL, 0xf0f0f0f0f0f0f0f0ULL, 0x0000000000000000ULL}},
+				{{0x0ea0ea0ea0ea0ea1ULL, 0xa0ea0ea0ea0ea0eaULL, 0xea0ea0ea0ea0ea0eULL, 0x0000000000000000ULL}},
+				{{0x8e38e38e38e38e39ULL, 0x38e38e38e38e38e3ULL, 0xe38e38e38e38e38eULL, 0x0000000000000000ULL}},
+				{{0x8a60dd67c8a60dd7ULL, 0x60dd67c8a60dd67cULL, 0xdd67c8a60dd67c8aULL, 0x0000000000000000ULL}},
+				{{0x5e50d79435e50d7aULL, 0x50d79435e50d7943ULL, 0xd79435e50d79435eULL, 0x0000000000000000ULL}},
+				{{0x0d20d20d20d20d21ULL, 0x20d20d20d20d20d2ULL, 0xd20d20d20d20d20dULL, 0x0000000000000000ULL}},
+				{{0xcccccccccccccccdULL, 0xccccccccccccccccULL, 0xccccccccccccccccULL, 0x0000000000000000ULL}},
+				{{0xce0c7ce0c7ce0c7dULL, 0x7ce0c7ce0c7ce0c7ULL, 0xc7ce0c7ce0c7ce0cULL, 0x0000000000000000ULL}},
+				{{0x0c30c30c30c30c31ULL, 0x30c30c30c30c30c3ULL, 0xc30c30c30c30c30cULL, 0x0000000000000000ULL}},
+				{{0xfa0be82fa0be82fbULL, 0x82fa0be82fa0be82ULL, 0xbe82fa0be82fa0beULL, 0x0000000000000000ULL}},
+				{{0x2e8ba2e8ba2e8ba3ULL, 0xa2e8ba2e8ba2e8baULL, 0xba2e8ba2e8ba2e8bULL, 0x0000000000000000ULL}},
+				{{0x0b60b60b60b60b61ULL, 0x60b60b60b60b60b6ULL, 0xb60b60b60b60b60bULL, 0x0000000000000000ULL}},
+				{{0x0b21642c8590b217ULL, 0x2c8590b21642c859ULL, 0xb21642c8590b2164ULL, 0x0000000000000000ULL}},
+				{{0x882b9310572620afULL, 0x0572620ae4c415c9ULL, 0xae4c415c9882b931ULL, 0x0000000000000000ULL}},
+				{{0xaaaaaaaaaaaaaaabULL, 0xaaaaaaaaaaaaaaaaULL, 0xaaaaaaaaaaaaaaaaULL, 0x0000000000000000ULL}},
+				{{0x9cbc14e5e0a72f06ULL, 0x4e5e0a72f0539782ULL, 0xa72f05397829cbc1ULL, 0x0000000000000000ULL}},
+				{{0xd70a3d70a3d70a3eULL, 0x3d70a3d70a3d70a3ULL, 0xa3d70a3d70a3d70aULL, 0x0000000000000000ULL}},
+				{{0xa0a0a0a0a0a0a0a1ULL, 0xa0a0a0a0a0a0a0a0ULL, 0xa0a0a0a0a0a0a0a0ULL, 0x0000000000000000ULL}},
+				{{0x89d89d89d89d89d9ULL, 0xd89d89d89d89d89dULL, 0x9d89d89d89d89d89ULL, 0x0000000000000000ULL}},
+				{{0xd95bc609a90e7d96ULL, 0x0e7d95bc609a90e7ULL, 0x9a90e7d95bc609a9ULL, 0x0000000000000000ULL}},
+				{{0x5ed097b425ed097cULL, 0xd097b425ed097b42ULL, 0x97b425ed097b425eULL, 0x0000000000000000ULL}},
+				{{0xf2094f2094f20950ULL, 0x4f2094f2094f2094ULL, 0x94f2094f2094f209ULL, 0x0000000000000000ULL}},
+				{{0x4924924924924925ULL, 0x2492492492492492ULL, 0x9249249249249249ULL, 0x0000000000000000ULL}},
+				{{0x3ee08fb823ee08fcULL, 0xe08fb823ee08fb82ULL, 0x8fb823ee08fb823eULL, 0x0000000000000000ULL}},
+				{{0xcb08d3dcb08d3dccULL, 0x3dcb08d3dcb08d3dULL, 0x8d3dcb08d3dcb08dULL, 0x0000000000000000ULL}},
+				{{0x8f2fba9386822b64ULL, 0xb63cbeea4e1a08adULL, 0x8ad8f2fba9386822ULL, 0x0000000000000000ULL}},
+				{{0x8888888888888889ULL, 0x8888888888888888ULL, 0x8888888888888888ULL, 0x0000000000000000ULL}},
+				{{0x4b8a7de6d1d60865ULL, 0x64b8a7de6d1d6086ULL, 0x864b8a7de6d1d608ULL, 0x0000000000000000ULL}},
+				{{0x2108421084210843ULL, 0x4210842108421084ULL, 0x8421084210842108ULL, 0x0000000000000000ULL}},
+				{{0x0820820820820821ULL, 0x2082082082082082ULL, 0x8208208208208208ULL, 0x0000000000000000ULL}}
+			};
+			const constexpr Fixed fixedLogReductionLog[32] =
+			{
+				{{0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL, 0x0000000000000000ULL}},
+				{{0xaefae14cddf35ad2ULL, 0x3e3f04f1ef229faeULL, 0x07e0a6c39e0cc013ULL, 0x0000000000000000ULL}},
+				{{0xd3474d3375b52596ULL, 0xbe64b8b775997898ULL, 0x0f85186008b15330ULL, 0x0000000000000000ULL}},
+				{{0x50c1ef65087fdf23ULL, 0xe499b9ed19b640ceULL, 0x16f0d28ae56b4b9bULL, 0x0000000000000000ULL}},
+				{{0xb94ebc4017f6f958ULL, 0xea87ffe1fe9e155dULL, 0x1e27076e2af2e5e9ULL, 0x0000000000000000ULL}},
+				{{0xfbc9070f7e29fbadULL, 0x0bb8e203edf4d109ULL, 0x252aa5f03fea4698ULL, 0x0000000000000000ULL}},
+				{{0xd55c7355fdf3e631ULL, 0xe7c4140e424775fcULL, 0x2bfe60e14f27a790ULL, 0x0000000000000000ULL}},
+				{{0xa0bed3cf71766947ULL, 0x8260ea71712cec4cULL, 0x32a4b539e8ad68ecULL, 0x0000000000000000ULL}},
+				{{0xc765ea7411adc1b1ULL, 0x4bb03de5ff734495ULL, 0x391fef8f35344358ULL, 0x0000000000000000ULL}},
+				{{0x40584455b22c817bULL, 0xaa8cd86f29a59412ULL, 0x3f7230dabc7c551aULL, 0x0000000000000000ULL}},
+				{{0x067d04a43c19f534ULL, 0x731f55c41b8b823fULL, 0x459d72aeae98380eULL, 0x0000000000000000ULL}},
+				{{0x77ad6fb226f15212ULL, 0xb3246a14206cf37bULL, 0x4ba38aeb8474c270ULL, 0x0000000000000000ULL}},
+				{{0x72cd24c00b44393dULL, 0x2decdeccf1cd1057ULL, 0x51862f08717b09f4ULL, 0x0000000000000000ULL}},
+				{{0x80b4a6b429a4bb09ULL, 0x36383dc7fe1159f3ULL, 0x5746f6fd60272942ULL, 0x0000000000000000ULL}},
+				{{0xdde10dcea59757bbULL, 0x89314feb4fbde5aaULL, 0x5ce75fdaef401a73ULL, 0x0000000000000000ULL}},
+				{{0xc63281b40515a31eULL, 0x9c620440f055b3ffULL, 0x6268ce1b05096ad6ULL, 0x0000000000000000ULL}},
+				{{0x7d20ffb34547d7c2ULL, 0xda35d9bd01488606ULL, 0x67cc8fb2fe612fcaULL, 0x0000000000000000ULL}},
+				{{0x53ab4d08603cf110ULL, 0xfbb6aba63878ef20ULL, 0x6d13ddef323d8a32ULL, 0x0000000000000000ULL}},
+				{{0x8ecbd4e8235b8362ULL, 0x97607bcbfee6892bULL, 0x723fdf1e6a6886b0ULL, 0x0000000000000000ULL}},
+				{{0x50684ce6bafcfd59ULL, 0x989a927476e1fe9fULL, 0x7751a813071282fbULL, 0x0000000000000000ULL}},
+				{{0x649117429ec747b1ULL, 0x720ec44c73d75cf5ULL, 0x7c4a3d7ebc1bb2cdULL, 0x0000000000000000ULL}},
+				{{0x4b8b8c4c34ebb89eULL, 0xe34aebf73ffe346eULL, 0x812a952d2e87f634ULL, 0x0000000000000000ULL}},
+				{{0x366fbbf35d3ed119ULL, 0xc4bdd99effe69b64ULL, 0x85f39721295415b4ULL, 0x0000000000000000ULL}},
+				{{0x3a330f341cf1faedULL, 0x799d1cb2f14054edULL, 0x8aa61e97a6af4d4cULL, 0x0000000000000000ULL}},
+				{{0xca4f4817696ad39fULL, 0x62cd2f9f1e35f2e7ULL, 0x8f42faf3820681efULL, 0x0000000000000000ULL}},
+				{{0x527d7309433bbdf4ULL, 0xc1f9edcb438ffc03ULL, 0x93caf0944d88d75bULL, 0x0000000000000000ULL}},
+				{{0x0b7013338119ba90ULL, 0xac850fab36cdee18ULL, 0x983eb99a7885f0fdULL, 0x0000000000000000ULL}},
+				{{0x1717c9e700413260ULL, 0x221301b6f8c38f62ULL, 0x9c9f069ab150cd4eULL, 0x0000000000000000ULL}},
+				{{0x4486ea2756f59973ULL, 0x25e617a300bbca9cULL, 0xa0ec7f4233957323ULL, 0x0000000000000000ULL}},
+				{{0x6f7191d8af47e744ULL, 0x3dfa3d3761b6316eULL, 0xa527c2ed81f5d811ULL, 0x0000000000000000ULL}},
+				{{0xd0920f6a4c39b31dULL, 0xbe4578ad97aea7beULL, 0xa9516932de2d5773ULL, 0x0000000000000000ULL}},
+				{{0x839e04578161ccf6ULL, 0x4d552f811cd40845ULL, 0xad6a0261acf967d9ULL, 0x0000000000000000ULL}}
+			};
+
+			const constexpr Fixed fixedOne = {{0, 0, 0, 1}};
+
+			inline unsigned fixedBitLength(const Fixed &a)
+			{
+				for(size_t i = 4; i > 0; --i)
+					if(a.w[i - 1] != 0)
+						return unsigned(64 * i) - countLeadingZeros(a.w[i - 1]);
+				return 0;
+			}
+
+			inline Fixed fixedShiftRight(const Fixed &a, unsigned bits)
+			{
+				Fixed ret = {};
+				const size_t words = bits / 64, s = bits % 64;
+				for(size_t i = 0; i + words < 4; ++i)
+				{
+					ret.w[i] = a.w[i + words] >> s;
+					if(s && i + words + 1 < 4)
+						ret.w[i] |= a.w[i + words + 1] << (64 - s);
+				}
+				return ret;
+			}
+
+			// throws std::out_of_range when bits are shifted out of the whole part
+			inline Fixed fixedShiftLeft(const Fixed &a, unsigned bits)
+			{
+				if(fixedBitLength(a) + bits > 256)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				Fixed ret = {};
+				const size_t words = bits / 64, s = bits % 64;
+				for(size_t i = words; i < 4; ++i)
+				{
+					ret.w[i] = a.w[i - words] << s;
+					if(s && i > words)
+						ret.w[i] |= a.w[i - words - 1] >> (64 - s);
+				}
+				return ret;
+			}
+
+			// (c2:c1:c0) += x * y
+			inline void fixedAccumulate(uint64_t x, uint64_t y, uint64_t &c0, uint64_t &c1, uint64_t &c2)
+			{
+				uint64_t hi = 0, lo = mul64x64(x, y, hi);
+				c0 += lo;
+				hi += (c0 < lo);
+				c1 += hi;
+				c2 += (c1 < hi);
+			}
+
+			// Column by column product of the words that reach the result. Columns 0 and 1 are skipped, which can
+			// lose one carry, so the result is at most 2^-191 below the exact product.
+			// Throws std::out_of_range when the whole part overflows.
+			inline Fixed fixedMultiply(const Fixed &a, const Fixed &b)
+			{
+				Fixed ret;
+				uint64_t c0 = 0, c1 = 0, c2 = 0;
+				fixedAccumulate(a.w[0], b.w[2], c0, c1, c2);
+				fixedAccumulate(a.w[1], b.w[1], c0, c1, c2);
+				fixedAccumulate(a.w[2], b.w[0], c0, c1, c2);
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+				fixedAccumulate(a.w[0], b.w[3], c0, c1, c2);
+				fixedAccumulate(a.w[1], b.w[2], c0, c1, c2);
+				fixedAccumulate(a.w[2], b.w[1], c0, c1, c2);
+				fixedAccumulate(a.w[3], b.w[0], c0, c1, c2);
+				ret.w[0] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+				fixedAccumulate(a.w[1], b.w[3], c0, c1, c2);
+				fixedAccumulate(a.w[2], b.w[2], c0, c1, c2);
+				fixedAccumulate(a.w[3], b.w[1], c0, c1, c2);
+				ret.w[1] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+				fixedAccumulate(a.w[2], b.w[3], c0, c1, c2);
+				fixedAccumulate(a.w[3], b.w[2], c0, c1, c2);
+				ret.w[2] = c0;
+				c0 = c1;
+				c1 = c2;
+				c2 = 0;
+				fixedAccumulate(a.w[3], b.w[3], c0, c1, c2);
+				ret.w[3] = c0;
+				if(c1 != 0 || c2 != 0)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				return ret;
+			}
+
+			// a * n for a small integer n, the result must fit
+			inline Fixed fixedMultiply(const Fixed &a, uint64_t n)
+			{
+				const WideUInt<1> b = {{n}};
+				const WideUInt<5> p = wideMultiply(a, b);
+				Fixed ret = {{p.w[0], p.w[1], p.w[2], p.w[3]}};
+				return ret;
+			}
+
+			// scaled / 10^19 with scaled < 2^64 * 10^19, as for a Decimal's magnitude
+			inline Fixed fixedFromScaled(const WideUInt<2> &scaled)
+			{
+				const constexpr uint64_t denominator = pow10Table[19];
+				const constexpr uint64_t reciprocal = reciprocalConstexpr(denominator);
+				Fixed ret;
+				uint64_t rem = 0;
+				ret.w[3] = div128by64Preinv(scaled.w[1], scaled.w[0], denominator, reciprocal, rem);
+				for(size_t i = 3; i-- > 0;)
+					ret.w[i] = div128by64Preinv(rem, 0, denominator, reciprocal, rem);
+				return ret;
+			}
+
+			// 10^19 / scaled, the reciprocal of a Decimal's magnitude without losing its relative precision first
+			inline Fixed fixedInverseFromScaled(const WideUInt<2> &scaled)
+			{
+				const Fixed num = {{0, 0, 0, pow10Table[19]}};
+				Fixed ret;
+				WideUInt<2> rem;
+				wideDivide(num, scaled, ret, rem);
+				return ret;
+			}
+
+			// rounds with mode, the bits below 10^-19 give roundingIncrement's remainder class
+			inline Decimal fixedToDecimal(const Fixed &value, bool negative, RoundingMode mode)
+			{
+				const WideUInt<3> fraction = {{value.w[0], value.w[1], value.w[2]}};
+				const WideUInt<1> denominator = {{pow10Table[19]}};
+				const WideUInt<4> digits = wideMultiply(fraction, denominator);
+				uint64_t remainder = 0;
+				if(digits.w[0] != 0 || digits.w[1] != 0 || digits.w[2] != 0)
+				{
+					const uint64_t half = 1ULL << 63;
+					remainder = digits.w[2] < half ? 1 : (digits.w[2] > half || digits.w[1] != 0 || digits.w[0] != 0 ? 3 : 2);
+				}
+				WideUInt<2> scaled = {};
+				scaled.w[0] = mul64x64(value.w[3], pow10Table[19], scaled.w[1]);
+				scaled.w[0] += digits.w[3];
+				scaled.w[1] += (scaled.w[0] < digits.w[3]);
+				return roundExpression(negative, scaled, remainder, mode);
+			}
+
+			// replaces scaled with 10^38 / scaled when that is exact, so 1 / value has at most 19 fraction digits
+			inline bool exactInverse(WideUInt<2> &scaled)
+			{
+				WideUInt<2> num = {};
+				num.w[0] = mul64x64(pow10Table[19], pow10Table[19], num.w[1]);
+				WideUInt<2> q, rem;
+				wideDivide(num, scaled, q, rem);
+				if(!wideIsZero(rem))
+					return false;
+				scaled = q;
+				return true;
+			}
+
+			// throws std::out_of_range when the product needs more than 4 words
+			inline WideUInt<4> exactMultiply(const WideUInt<4> &a, const WideUInt<4> &b)
+			{
+				const WideUInt<8> p = wideMultiply(a, b);
+				if(p.w[4] != 0 || p.w[5] != 0 || p.w[6] != 0 || p.w[7] != 0)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				WideUInt<4> ret = {{p.w[0], p.w[1], p.w[2], p.w[3]}};
+				return ret;
+			}
+
+			// (scaled / 10^19)^exponent with integer arithmetic when the result has at most 19 fraction digits.
+			// Returns false when it has more, throws std::out_of_range when it does not fit.
+			inline bool exactPow(const WideUInt<2> &scaled, uint64_t exponent, bool negative, Decimal &result)
+			{
+				const constexpr uint64_t denominator = pow10Table[19];
+				const constexpr uint64_t reciprocal = reciprocalConstexpr(denominator);
+				uint64_t fraction = 0;
+				const uint64_t whole = div128by64Preinv(scaled.w[1], scaled.w[0], denominator, reciprocal, fraction);
+
+				// base = mantissa / 10^digits with the trailing zeros of the fraction dropped
+				unsigned digits = 0;
+				if(fraction != 0)
+				{
+					digits = 19;
+					while(fraction % 10 == 0)
+					{
+						fraction /= 10;
+						--digits;
+					}
+				}
+				if(digits != 0 && exponent > 19 / digits)
+					return false;
+				WideUInt<4> mantissa = {};
+				mantissa.w[0] = mul64x64(whole, pow10Table[digits], mantissa.w[1]);
+				mantissa.w[0] += fraction;
+				mantissa.w[1] += (mantissa.w[0] < fraction);
+
+				const unsigned resultDigits = unsigned(digits * exponent);
+				WideUInt<4> power = {{1, 0, 0, 0}};
+				for(;;)
+				{
+					if(exponent & 1)
+						power = exactMultiply(power, mantissa);
+					exponent >>= 1;
+					if(exponent == 0)
+						break;
+					mantissa = exactMultiply(mantissa, mantissa);
+				}
+
+				const WideUInt<1> scale = {{pow10Table[resultDigits]}};
+				WideUInt<4> q;
+				WideUInt<1> rem;
+				wideDivide(power, scale, q, rem);
+				if(q.w[1] != 0 || q.w[2] != 0 || q.w[3] != 0)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+				result = ExpressionAccess::make(negative, q.w[0], rem.w[0] * pow10Table[19 - resultDigits]);
+				return true;
+			}
+
+			inline Fixed fixedPow(Fixed base, uint64_t exponent)
+			{
+				Fixed power = fixedOne;
+				for(;;)
+				{
+					if(exponent & 1)
+						power = fixedMultiply(power, base);
+					exponent >>= 1;
+					if(exponent == 0)
+						break;
+					base = fixedMultiply(base, base);
+				}
+				return power;
+			}
+
+			// e^(negative ? -value : value), throws std::out_of_range when the result does not fit
+			inline Fixed fixedExp(const Fixed &value, bool negative)
+			{
+				if(value.w[3] >= 64)
+				{
+					if(!negative)
+						DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - Decimal out of range"));
+					// far below 10^-19 but not 0, so it rounds like the tiny positive value it is
+					const Fixed tiny = {{1, 0, 0, 0}};
+					return tiny;
+				}
+
+				// value = k * ln(2) + r with |r| <= ln(2) / 2
+				Fixed k = fixedMultiply(value, fixedInverseLn2);
+				const uint64_t half = 1ULL << 63;
+				k.w[2] += half;
+				k.w[3] += (k.w[2] < half);
+				const uint64_t shift = k.w[3];
+				Fixed r = value;
+				bool rNegative = false;
+				wideSignedAdd(rNegative, r, true, fixedMultiply(fixedLn2, shift));
+
+				// e^r = (e^(r / 256))^256, for |r / 256| < 2^-9 the series is within 2^-149 after 13 terms,
+				// 2^-141 after squaring
+				const bool seriesNegative = (negative != rNegative);
+				const Fixed t = fixedShiftRight(r, 8);
+				Fixed sum = fixedInverseFactorial[12];
+				for(size_t n = 12; n-- > 0;)
+				{
+					const Fixed term = fixedMultiply(t, sum);
+					sum = fixedInverseFactorial[n];
+					if(seriesNegative)
+						wideSubtract(sum, term);
+					else
+						wideAdd(sum, term);
+				}
+				for(int i = 0; i < 8; ++i)
+					sum = fixedMultiply(sum, sum);
+				return negative ? fixedShiftRight(sum, unsigned(shift)) : fixedShiftLeft(sum, unsigned(shift));
+			}
+
+			// |ln(value)| and its sign, value must not be 0
+			inline Fixed fixedLog(const Fixed &value, bool &negative)
+			{
+				// value = 2^e * m with m in [1, 2)
+				const int e = int(fixedBitLength(value)) - 193;
+				const Fixed m = e > 0 ? fixedShiftRight(value, unsigned(e)) : fixedShiftLeft(value, unsigned(-e));
+
+				// m * r_j = 1 + u with u in [0, 1/32], ln(m) = ln(1 + u) - ln(r_j)
+				const size_t j = size_t(m.w[2] >> 59);
+				Fixed u = fixedMultiply(m, fixedLogReduction[j]);
+				u.w[3] -= 1;
+
+				// ln(1 + u) = 2 * atanh(z) with z = u / (2 + u) <= 1/65, the series is within z * 2^-144 after 12 terms
+				WideUInt<6> num = {};
+				for(size_t i = 0; i < 3; ++i)
+					num.w[i + 3] = u.w[i];
+				Fixed den = u;
+				den.w[3] += 2;
+				WideUInt<6> q;
+				Fixed rem;
+				wideDivide(num, den, q, rem);
+				const Fixed z = {{q.w[0], q.w[1], q.w[2], q.w[3]}};
+				const Fixed z2 = fixedMultiply(z, z);
+				Fixed sum = fixedInverseOdd[11];
+				for(size_t n = 11; n-- > 0;)
+				{
+					sum = fixedMultiply(z2, sum);
+					wideAdd(sum, fixedInverseOdd[n]);
+				}
+
+				Fixed ret = fixedShiftLeft(fixedMultiply(z, sum), 1);
+				wideAdd(ret, fixedLogReductionLog[j]);
+				negative = false;
+				wideSignedAdd(negative, ret, e < 0, fixedMultiply(fixedLn2, uint64_t(e < 0 ? -e : e)));
+				return ret;
+			}
+
+			// floor(sqrt(n)) from a double estimate, one Newton step on the 128 bit root and an exact fix up.
+			// remainder is the roundingIncrement class of the rest of the root.
+			inline WideUInt<2> wideSqrt(const WideUInt<3> &n, uint64_t &remainder)
+			{
+				WideUInt<2> root = {};
+				remainder = 0;
+				if(wideIsZero(n))
+					return root;
+				const double estimate = std::sqrt(std::ldexp(double(n.w[2]), 128) + std::ldexp(double(n.w[1]), 64) + double(n.w[0]));
+				root.w[1] = uint64_t(std::ldexp(estimate, -64));
+				root.w[0] = uint64_t(estimate - std::ldexp(double(root.w[1]), 64));
+				if(wideIsZero(root))
+					root.w[0] = 1;
+
+				WideUInt<3> q;
+				WideUInt<2> rem;
+				wideDivide(n, root, q, rem);
+				WideUInt<2> sum = {{q.w[0], q.w[1]}};
+				wideAdd(sum, root);
+				root.w[0] = sum.w[0] >> 1 | sum.w[1] << 63;
+				root.w[1] = sum.w[1] >> 1;
+
+				const WideUInt<4> target = wideWiden<4>(n);
+				WideUInt<4> square = wideMultiply(root, root);
+				while(wideCompare(square, target) > 0)
+				{
+					if(root.w[0]-- == 0)
+						--root.w[1];
+					square = wideMultiply(root, root);
+				}
+				for(;;)
+				{
+					WideUInt<2> next = root;
+					if(++next.w[0] == 0)
+						++next.w[1];
+					const WideUInt<4> nextSquare = wideMultiply(next, next);
+					if(wideCompare(nextSquare, target) > 0)
+						break;
+					root = next;
+					square = nextSquare;
+				}
+
+				// (root + 1/2)^2 = root^2 + root + 1/4, so the rest is above half exactly when n - root^2 > root
+				WideUInt<4> rest = target;
+				wideSubtract(rest, square);
+				if(!wideIsZero(rest))
+					remainder = wideCompare(rest, wideWiden<4>(root)) > 0 ? 3 : 1;
+				return root;
+			}
+		}
+
+		// Accuracy: pow, exp and log work in binary fixed point with 192 fraction bits and round once with mode.
+		// Before that rounding the result is within max(|exact| * 2^-120, 2^-160) of the exact value, so it is the
+		// exact value rounded with mode unless the exact value lies that close to a rounding boundary, where it can be
+		// the neighbouring Decimal (off by 10^-19). sqrt and the exact cases of pow are always correctly rounded.
+
+		// base^exponent by repeated squaring, 0^0 is 1.
+		// Exact when the result has at most 19 fraction digits (a negative exponent raises the exact 1 / base when it has).
+		// Throws std::runtime_error for 0 to a negative power and std::out_of_range when the result does not fit.
+		inline Decimal pow(const Decimal &base, int64_t exponent, RoundingMode mode = RoundingMode::Truncate)
+		{
+			if(exponent == 0)
+				return Decimal(1);
+			const detail::ExpressionValue<2, 0> value = detail::ExpressionAccess::value(base);
+			if(detail::wideIsZero(value.num))
+			{
+				if(exponent < 0)
+					DECIMAL_THROW(std::runtime_error(__FILE__ ":" STR__LINE__ " - division by zero"));
+				return Decimal(0);
+			}
+			const bool negative = value.negative && (exponent & 1) != 0;
+			const uint64_t magnitude = exponent < 0 ? 0 - uint64_t(exponent) : uint64_t(exponent);
+			detail::WideUInt<2> scaled = value.num;
+			Decimal result;
+			if((exponent > 0 || detail::exactInverse(scaled)) && detail::exactPow(scaled, magnitude, negative, result))
+				return result;
+			const detail::Fixed x = exponent > 0 ? detail::fixedFromScaled(scaled) : detail::fixedInverseFromScaled(value.num);
+			return detail::fixedToDecimal(detail::fixedPow(x, magnitude), negative, mode);
+		}
+
+		// Correctly rounded square root. Throws std::invalid_argument for negative values.
+		inline Decimal sqrt(const Decimal &value, RoundingMode mode = RoundingMode::Truncate)
+		{
+			const detail::ExpressionValue<2, 0> v = detail::ExpressionAccess::value(value);
+			if(v.negative && !detail::wideIsZero(v.num))
+				DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - sqrt of a negative value"));
+			// sqrt(scaled / 10^19) * 10^19 = sqrt(scaled * 10^19)
+			const detail::WideUInt<1> denominator = {{detail::pow10Table[19]}};
+			uint64_t remainder = 0;
+			const detail::WideUInt<2> root = detail::wideSqrt(detail::wideMultiply(v.num, denominator), remainder);
+			return detail::roundExpression(false, root, remainder, mode);
+		}
+
+		// e^value. Throws std::out_of_range above ln(2^64) (about 44.36).
+		inline Decimal exp(const Decimal &value, RoundingMode mode = RoundingMode::Truncate)
+		{
+			const detail::ExpressionValue<2, 0> v = detail::ExpressionAccess::value(value);
+			return detail::fixedToDecimal(detail::fixedExp(detail::fixedFromScaled(v.num), v.negative), false, mode);
+		}
+
+		// Natural logarithm. Throws std::invalid_argument for values <= 0.
+		inline Decimal log(const Decimal &value, RoundingMode mode = RoundingMode::Truncate)
+		{
+			const detail::ExpressionValue<2, 0> v = detail::ExpressionAccess::value(value);
+			if(v.negative || detail::wideIsZero(v.num))
+				DECIMAL_THROW(std::invalid_argument(__FILE__ ":" STR__LINE__ " - log of a value <= 0"));
+			bool negative = false;
+			const detail::Fixed ret = detail::fixedLog(detail::fixedFromScaled(v.num), negative);
+			return detail::fixedToDecimal(ret, negative, mode);
+		}
+	}
+}
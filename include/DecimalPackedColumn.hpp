@@ -0,0 +1,391 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+#include "Decimal.hpp"
+#include "DecimalColumn.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		namespace detail
+		{
+			// Packed blocks interleave 8 lanes: value i of a block is slot i / 8 of lane i % 8, and word w of
+			// lane l is block word w * 8 + l. Every lane shifts by the same amount, so one vector covers all lanes.
+			const constexpr size_t packedLanes = 8;
+			const constexpr size_t packedSlots = 64;
+
+			inline uint64_t packedMask(uint8_t bits)
+			{
+				return bits == 64 ? ~0ULL : (1ULL << bits) - 1;
+			}
+
+			// out[i] = base + delta i for a full block, out must hold packedLanes * packedSlots values
+			inline void unpackScalar(const uint64_t *in, uint8_t bits, uint64_t base, uint64_t *out)
+			{
+				const uint64_t mask = packedMask(bits);
+				for(size_t slot = 0; slot < packedSlots; ++slot)
+				{
+					const size_t bit = slot * bits, word = bit / 64, shift = bit % 64;
+					const bool straddles = shift + bits > 64;
+					for(size_t lane = 0; lane < packedLanes; ++lane)
+					{
+						uint64_t v = in[word * packedLanes + lane] >> shift;
+						if(straddles)
+							v |= in[(word + 1) * packedLanes + lane] << (64 - shift);
+						out[slot * packedLanes + lane] = base + (v & mask);
+					}
+				}
+			}
+
+#ifdef DECIMAL_X86_SIMD
+			__attribute__((target("avx2")))
+			inline void unpackAvx2(const uint64_t *in, uint8_t bits, uint64_t base, uint64_t *out)
+			{
+				const __m256i mask = _mm256_set1_epi64x(int64_t(packedMask(bits)));
+				const __m256i b = _mm256_set1_epi64x(int64_t(base));
+				for(size_t slot = 0; slot < packedSlots; ++slot)
+				{
+					const size_t bit = slot * bits, word = bit / 64, shift = bit % 64;
+					const __m128i right = _mm_cvtsi64_si128(int64_t(shift));
+					const uint64_t *p = in + word * packedLanes;
+					__m256i lo = _mm256_srl_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), right);
+					__m256i hi = _mm256_srl_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 4)), right);
+					if(shift + bits > 64)
+					{
+						const __m128i left = _mm_cvtsi64_si128(int64_t(64 - shift));
+						lo = _mm256_or_si256(lo, _mm256_sll_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + packedLanes)), left));
+						hi = _mm256_or_si256(hi, _mm256_sll_epi64(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + packedLanes + 4)), left));
+					}
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + slot * packedLanes), _mm256_add_epi64(b, _mm256_and_si256(lo, mask)));
+					_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + slot * packedLanes + 4), _mm256_add_epi64(b, _mm256_and_si256(hi, mask)));
+				}
+			}
+
+			__attribute__((target("avx512f")))
+			inline void unpackAvx512(const uint64_t *in, uint8_t bits, uint64_t base, uint64_t *out)
+			{
+				const __m512i mask = _mm512_set1_epi64(int64_t(packedMask(bits)));
+				const __m512i b = _mm512_set1_epi64(int64_t(base));
+				for(size_t slot = 0; slot < packedSlots; ++slot)
+				{
+					const size_t bit = slot * bits, word = bit / 64, shift = bit % 64;
+					const uint64_t *p = in + word * packedLanes;
+					__m512i v = _mm512_srl_epi64(_mm512_loadu_si512(p), _mm_cvtsi64_si128(int64_t(shift)));
+					if(shift + bits > 64)
+						v = _mm512_or_si512(v, _mm512_sll_epi64(_mm512_loadu_si512(p + packedLanes), _mm_cvtsi64_si128(int64_t(64 - shift))));
+					_mm512_storeu_si512(out + slot * packedLanes, _mm512_add_epi64(b, _mm512_and_si512(v, mask)));
+				}
+			}
+#endif
+
+			inline void unpack(SimdLevel level, const uint64_t *in, uint8_t bits, uint64_t base, uint64_t *out)
+			{
+				if(bits == 0)
+				{
+					std::fill(out, out + packedLanes * packedSlots, base);
+					return;
+				}
+				switch(level)
+				{
+#ifdef DECIMAL_X86_SIMD
+				case SimdLevel::AVX512:
+					return unpackAvx512(in, bits, base, out);
+				case SimdLevel::AVX2:
+					return unpackAvx2(in, bits, base, out);
+#endif
+				default:
+					return unpackScalar(in, bits, base, out);
+				}
+			}
+
+			// the inverse of unpack for count <= packedLanes * packedSlots deltas, out holds bits * packedLanes zeroed words
+			inline void pack(const uint64_t *deltas, size_t count, uint8_t bits, uint64_t *out)
+			{
+				if(bits == 0)
+					return;
+				for(size_t i = 0; i < count; ++i)
+				{
+					const size_t lane = i % packedLanes, bit = (i / packedLanes) * bits, word = bit / 64, shift = bit % 64;
+					out[word * packedLanes + lane] |= deltas[i] << shift;
+					if(shift + bits > 64)
+						out[(word + 1) * packedLanes + lane] |= deltas[i] >> (64 - shift);
+				}
+			}
+		}
+
+		// Compressed, read only storage for Decimal sequences such as one instrument's prices.
+		// Values are scaled by 10^fractionDigits(), the fewest fraction digits that keep every value exact, and
+		// stored per block of BLOCK_SIZE as bit packed deltas from the block minimum (frame of reference).
+		// A block holding a value whose scaled form does not fit in int64_t keeps its Decimals as they are.
+		// Each block keeps its min and max so scans can skip it, decode(block, ...) unpacks one block with
+		// AVX-512 or AVX2 when the cpu has it and operator[] reads one value without decoding its block.
+		class DecimalPackedColumn
+		{
+		public:
+			static const constexpr size_t BLOCK_SIZE = detail::packedLanes * detail::packedSlots;
+
+			DecimalPackedColumn() : size_(0), fractionDigits_(0), magicShift_(0), unit_(1), magic_(0)
+			{ }
+
+			// first and last are random access, e.g. Decimal pointers or std::vector<Decimal> iterators
+			template<typename RandomIt>
+			DecimalPackedColumn(RandomIt first, RandomIt last) : DecimalPackedColumn()
+			{
+				encode(size_t(last - first), [&](size_t i) { return Decimal(first[i]); });
+			}
+
+			explicit DecimalPackedColumn(const DecimalColumn &column) : DecimalPackedColumn()
+			{
+				encode(column.size(), [&](size_t i) { return column[i]; });
+			}
+
+			size_t size() const
+			{
+				return size_;
+			}
+
+			bool empty() const
+			{
+				return size_ == 0;
+			}
+
+			size_t blockCount() const
+			{
+				return blocks_.size();
+			}
+
+			// values in block, BLOCK_SIZE for every block but the last
+			size_t blockSize(size_t block) const
+			{
+				const size_t rest = size_ - block * BLOCK_SIZE;
+				return rest < BLOCK_SIZE ? rest : BLOCK_SIZE;
+			}
+
+			const Decimal& blockMin(size_t block) const
+			{
+				return blocks_[block].min;
+			}
+
+			const Decimal& blockMax(size_t block) const
+			{
+				return blocks_[block].max;
+			}
+
+			// false when the block keeps plain Decimals, decodeScaled throws for those
+			bool scaledBlock(size_t block) const
+			{
+				return !blocks_[block].raw;
+			}
+
+			// scaled integers are the values times 10^fractionDigits()
+			uint8_t fractionDigits() const
+			{
+				return fractionDigits_;
+			}
+
+			// bytes held by the packed data, the plain Decimals and the block headers
+			size_t memoryUsage() const
+			{
+				return words_.size() * sizeof(uint64_t) + raw_.size() * sizeof(Decimal) + blocks_.size() * sizeof(Block);
+			}
+
+			Decimal operator[](size_t i) const
+			{
+				const Block &b = blocks_[i / BLOCK_SIZE];
+				const size_t j = i % BLOCK_SIZE;
+				if(b.raw)
+					return raw_[b.offset + j];
+				if(b.bits == 0)
+					return toDecimal(b.base);
+				const size_t lane = j % detail::packedLanes, bit = (j / detail::packedLanes) * b.bits, word = bit / 64, shift = bit % 64;
+				const uint64_t *in = words_.data() + b.offset;
+				uint64_t v = in[word * detail::packedLanes + lane] >> shift;
+				if(shift + b.bits > 64)
+					v |= in[(word + 1) * detail::packedLanes + lane] << (64 - shift);
+				return toDecimal(b.base + (v & detail::packedMask(b.bits)));
+			}
+
+			// Writes blockSize(block) scaled values to out, returns the count.
+			// Throws std::out_of_range if the block's values do not fit in int64_t, see scaledBlock.
+			size_t decodeScaled(size_t block, int64_t *out) const
+			{
+				const Block &b = blocks_[block];
+				if(b.raw)
+					DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - block values do not fit in int64_t"));
+				const size_t count = blockSize(block);
+				if(count == BLOCK_SIZE)
+				{
+					detail::unpack(simdLevel(), words_.data() + b.offset, b.bits, b.base, reinterpret_cast<uint64_t*>(out));
+					return count;
+				}
+				uint64_t tmp[BLOCK_SIZE];
+				detail::unpack(simdLevel(), words_.data() + b.offset, b.bits, b.base, tmp);
+				std::copy(tmp, tmp + count, out);
+				return count;
+			}
+
+			// Writes blockSize(block) values to out, returns the count.
+			size_t decode(size_t block, Decimal *out) const
+			{
+				const Block &b = blocks_[block];
+				const size_t count = blockSize(block);
+				if(b.raw)
+				{
+					std::copy(raw_.begin() + b.offset, raw_.begin() + b.offset + count, out);
+					return count;
+				}
+				uint64_t tmp[BLOCK_SIZE];
+				detail::unpack(simdLevel(), words_.data() + b.offset, b.bits, b.base, tmp);
+				for(size_t i = 0; i < count; ++i)
+					out[i] = toDecimal(tmp[i]);
+				return count;
+			}
+
+			// every value, out is resized to size()
+			void decode(std::vector<Decimal> &out) const
+			{
+				out.resize(size_);
+				for(size_t block = 0; block < blocks_.size(); ++block)
+					decode(block, out.data() + block * BLOCK_SIZE);
+			}
+
+		private:
+			struct Block
+			{
+				Decimal min;
+				Decimal max;
+				uint64_t base;// scaled minimum as two's complement
+				size_t offset;// into words_, or into raw_ for raw blocks
+				uint8_t bits;// delta width, 0 when every value is base
+				bool raw;
+			};
+
+			template<typename Get>
+			void encode(size_t count, const Get &get)
+			{
+				size_ = count;
+				// fewest fraction digits that keep every value exact
+				for(size_t i = 0; i < count && fractionDigits_ < Decimal::FRACTION_DIGITS; ++i)
+				{
+					const uint64_t fraction = get(i).fraction_;
+					while(fractionDigits_ < Decimal::FRACTION_DIGITS && fraction % detail::pow10Table[Decimal::FRACTION_DIGITS - fractionDigits_] != 0)
+						++fractionDigits_;
+				}
+				if(fractionDigits_ != 0)
+				{
+					// magnitudes are below 2^63, so ceil(2^(63 + l) / 10^k) with 2^(l - 1) < 10^k < 2^l fits in 64 bits and
+					// (magnitude * magic_) >> (63 + l) is the exact quotient (Granlund and Montgomery)
+					unit_ = detail::pow10Table[fractionDigits_];
+					magicShift_ = uint8_t(63 - detail::countLeadingZeros(unit_));
+					uint64_t rem = 0;
+					magic_ = detail::div128by64(1ULL << magicShift_, 0, unit_, rem) + 1;
+				}
+
+				blocks_.reserve((count + BLOCK_SIZE - 1) / BLOCK_SIZE);
+				uint64_t scaled[BLOCK_SIZE];
+				for(size_t first = 0; first < count; first += BLOCK_SIZE)
+				{
+					const size_t n = count - first < BLOCK_SIZE ? count - first : BLOCK_SIZE;
+					Block b = {get(first), get(first), 0, 0, 0, false};
+					int64_t lo = INT64_MAX, hi = INT64_MIN;
+					for(size_t i = 0; i < n && !b.raw; ++i)
+					{
+						int64_t s = 0;
+						b.raw = !toScaled(get(first + i), s);
+						lo = std::min(lo, s);
+						hi = std::max(hi, s);
+						scaled[i] = uint64_t(s);
+					}
+
+					if(b.raw)
+					{
+						b.offset = raw_.size();
+						for(size_t i = 0; i < n; ++i)
+						{
+							const Decimal value = get(first + i);
+							raw_.push_back(value);
+							b.min = value < b.min ? value : b.min;
+							b.max = b.max < value ? value : b.max;
+						}
+					}
+					else
+					{
+						const uint64_t range = uint64_t(hi) - uint64_t(lo);
+						b.base = uint64_t(lo);
+						b.bits = range ? uint8_t(64 - detail::countLeadingZeros(range)) : 0;
+						b.min = toDecimal(uint64_t(lo));
+						b.max = toDecimal(uint64_t(hi));
+						b.offset = words_.size();
+						for(size_t i = 0; i < n; ++i)
+							scaled[i] -= b.base;
+						words_.resize(words_.size() + size_t(b.bits) * detail::packedLanes);
+						detail::pack(scaled, n, b.bits, words_.data() + b.offset);
+					}
+					blocks_.push_back(b);
+				}
+				words_.shrink_to_fit();
+				raw_.shrink_to_fit();
+			}
+
+			// false when value * 10^fractionDigits_ does not fit in int64_t
+			bool toScaled(const Decimal &value, int64_t &out) const
+			{
+				uint64_t hi = 0, lo = detail::mul64x64(value.whole_, detail::pow10Table[fractionDigits_], hi);
+				const uint64_t fraction = value.fraction_ / detail::pow10Table[Decimal::FRACTION_DIGITS - fractionDigits_];
+				lo += fraction;
+				hi += (lo < fraction);
+				if(hi != 0 || lo > uint64_t(INT64_MAX))
+					return false;
+				out = value.positive_ ? int64_t(lo) : -int64_t(lo);
+				return true;
+			}
+
+			Decimal toDecimal(uint64_t scaled) const
+			{
+				Decimal ret;
+				ret.positive_ = int64_t(scaled) >= 0;
+				const uint64_t magnitude = ret.positive_ ? scaled : 0 - scaled;
+				if(fractionDigits_ == 0)
+				{
+					ret.whole_ = magnitude;
+					ret.fraction_ = 0;
+					return ret;
+				}
+				uint64_t hi = 0;
+				detail::mul64x64(magnitude, magic_, hi);
+				ret.whole_ = hi >> magicShift_;
+				ret.fraction_ = (magnitude - ret.whole_ * unit_) * detail::pow10Table[Decimal::FRACTION_DIGITS - fractionDigits_];
+				return ret;
+			}
+
+			size_t size_;
+			uint8_t fractionDigits_;
+			uint8_t magicShift_;
+			uint64_t unit_;
+			uint64_t magic_;
+			std::vector<Block> blocks_;
+			std::vector<uint64_t> words_;
+			std::vector<Decimal> raw_;
+		};
+	}
+}
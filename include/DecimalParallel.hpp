@@ -0,0 +1,232 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+#pragma once
+
+#include "DecimalAccumulator.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		// Work stealing pool: every worker owns a task deque, pops its own newest task and steals the oldest task of
+		// the others when it runs dry. The thread calling parallelFor runs tasks too, so a pool of n threads starts n-1 workers.
+		class ThreadPool
+		{
+		public:
+			explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency()) : pending_(0), stop_(false)
+			{
+				if(threadCount == 0)
+					threadCount = 1;
+				for(size_t i = 0; i < threadCount; ++i)
+					queues_.emplace_back(new Queue());
+				for(size_t i = 1; i < threadCount; ++i)
+					workers_.emplace_back([this, i] { workerLoop(i); });
+			}
+
+			~ThreadPool()
+			{
+				{
+					std::lock_guard<std::mutex> lock(sleepMutex_);
+					stop_ = true;
+				}
+				wake_.notify_all();
+				for(std::thread &worker : workers_)
+					worker.join();
+			}
+
+			ThreadPool(const ThreadPool&) = delete;
+			ThreadPool& operator=(const ThreadPool&) = delete;
+
+			size_t size() const
+			{
+				return queues_.size();
+			}
+
+			// Calls fn(begin, end) over [0, count) split into chunks and returns when all have run.
+			// The first exception thrown by fn is rethrown here after the remaining chunks finish.
+			template<typename Fn>
+			void parallelFor(size_t count, Fn fn)
+			{
+				if(count == 0)
+					return;
+				size_t chunks = std::min(count, size() * 4);
+				size_t chunkSize = (count + chunks - 1) / chunks;
+				chunks = (count + chunkSize - 1) / chunkSize;
+
+				std::atomic<size_t> remaining(chunks);
+				std::exception_ptr error;
+				std::mutex errorMutex;
+				{
+					// counted before any task is visible, so a worker popping one can not take pending_ below zero
+					std::lock_guard<std::mutex> lock(sleepMutex_);
+					pending_ += chunks;
+				}
+				for(size_t c = 0; c < chunks; ++c)
+				{
+					size_t begin = c * chunkSize;
+					size_t end = std::min(count, begin + chunkSize);
+					Queue &queue = *queues_[c % queues_.size()];
+					std::lock_guard<std::mutex> lock(queue.mutex);
+					queue.tasks.push_back([&, begin, end]
+					{
+						try
+						{
+							fn(begin, end);
+						}
+						catch(...)
+						{
+							std::lock_guard<std::mutex> errorLock(errorMutex);
+							if(!error)
+								error = std::current_exception();
+						}
+						--remaining;
+					});
+				}
+				wake_.notify_all();
+
+				while(remaining != 0)
+				{
+					if(!runOne(0))
+						std::this_thread::yield();
+				}
+				if(error)
+					std::rethrow_exception(error);
+			}
+
+		private:
+			struct Queue
+			{
+				std::mutex mutex;
+				std::deque<std::function<void()>> tasks;
+			};
+
+			bool runOne(size_t self)
+			{
+				std::function<void()> task;
+				for(size_t i = 0; i < queues_.size() && !task; ++i)
+				{
+					Queue &queue = *queues_[(self + i) % queues_.size()];
+					std::lock_guard<std::mutex> lock(queue.mutex);
+					if(queue.tasks.empty())
+						continue;
+					if(i == 0)
+					{
+						task = std::move(queue.tasks.back());
+						queue.tasks.pop_back();
+					}
+					else
+					{
+						task = std::move(queue.tasks.front());
+						queue.tasks.pop_front();
+					}
+				}
+				if(!task)
+					return false;
+				--pending_;
+				task();
+				return true;
+			}
+
+			void workerLoop(size_t self)
+			{
+				while(true)
+				{
+					if(runOne(self))
+						continue;
+					std::unique_lock<std::mutex> lock(sleepMutex_);
+					wake_.wait(lock, [this] { return stop_ || pending_ != 0; });
+					if(stop_ && pending_ == 0)
+						return;
+				}
+			}
+
+			std::vector<std::unique_ptr<Queue>> queues_;
+			std::vector<std::thread> workers_;
+			std::atomic<size_t> pending_;
+			std::mutex sleepMutex_;
+			std::condition_variable wake_;
+			bool stop_;
+		};
+
+		// shared pool sized to the hardware, created on first use
+		inline ThreadPool& defaultThreadPool()
+		{
+			static ThreadPool pool;
+			return pool;
+		}
+
+		// Exact sum through DecimalAccumulator, so the result does not depend on the thread count or chunking.
+		// Throws std::out_of_range if the total does not fit in a Decimal.
+		template<typename RandomIt>
+		Decimal parallel_sum(RandomIt first, RandomIt last, ThreadPool &pool = defaultThreadPool())
+		{
+			DecimalAccumulator total;
+			std::mutex totalMutex;
+			pool.parallelFor(static_cast<size_t>(std::distance(first, last)), [&](size_t begin, size_t end)
+			{
+				DecimalAccumulator part;
+				part.add(first + begin, first + end);
+				std::lock_guard<std::mutex> lock(totalMutex);
+				total.merge(part);
+			});
+			return total.result();
+		}
+
+		// sum of a[i] * b[i], each product rounded exactly like Decimal::operator*, summed exactly
+		template<typename RandomIt1, typename RandomIt2>
+		Decimal parallel_dot(RandomIt1 first1, RandomIt1 last1, RandomIt2 first2, ThreadPool &pool = defaultThreadPool())
+		{
+			DecimalAccumulator total;
+			std::mutex totalMutex;
+			pool.parallelFor(static_cast<size_t>(std::distance(first1, last1)), [&](size_t begin, size_t end)
+			{
+				DecimalAccumulator part;
+				for(size_t i = begin; i < end; ++i)
+					part.add(first1[i] * first2[i]);
+				std::lock_guard<std::mutex> lock(totalMutex);
+				total.merge(part);
+			});
+			return total.result();
+		}
+
+		// d_first[i] = op(first[i]); op is called concurrently and must not depend on call order
+		template<typename RandomIt, typename OutputRandomIt, typename UnaryOp>
+		OutputRandomIt parallel_transform(RandomIt first, RandomIt last, OutputRandomIt d_first, UnaryOp op, ThreadPool &pool = defaultThreadPool())
+		{
+			size_t count = static_cast<size_t>(std::distance(first, last));
+			pool.parallelFor(count, [&](size_t begin, size_t end)
+			{
+				for(size_t i = begin; i < end; ++i)
+					d_first[i] = op(first[i]);
+			});
+			return d_first + count;
+		}
+	}
+}
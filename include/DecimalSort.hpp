@@ -0,0 +1,199 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "Decimal.hpp"
+
+namespace tylawin
+{
+	namespace DataTypes
+	{
+		enum class SortOrder
+		{
+			Ascending,
+			Descending
+		};
+
+		// unsigned key whose unsigned order is Decimal order
+		typedef detail::uint128_t DecimalSortKey;
+
+		namespace detail
+		{
+			struct SortAccess
+			{
+				static const constexpr size_t RADIX_DIGITS = 16;
+				static const constexpr size_t RADIX_SORT_MIN = 256; // std::sort is faster below this
+
+				// Within one sign Decimal::less orders (whole, fraction), complemented for negative values.
+				// words[0] is the fraction and words[1] the whole part, giving 16 one byte radix digits.
+				struct RadixKey
+				{
+					uint64_t words[2];
+				};
+
+				// true for values that sort after the other sign in this order
+				static bool radixGroup(const Decimal &value, bool descending)
+				{
+					return value.positive_ != descending;
+				}
+
+				static RadixKey radixKey(const Decimal &value, bool descending)
+				{
+					const uint64_t mask = value.positive_ != descending ? 0 : ~0ULL;
+					return RadixKey{{value.fraction_ ^ mask, value.whole_ ^ mask}};
+				}
+
+				static Decimal fromRadixKey(const RadixKey &key, bool group, bool descending)
+				{
+					const uint64_t mask = group ? 0 : ~0ULL;
+					Decimal ret;
+					ret.positive_ = group != descending;
+					ret.whole_ = key.words[1] ^ mask;
+					ret.fraction_ = key.words[0] ^ mask;
+					return ret;
+				}
+
+				static size_t digit(const RadixKey &key, size_t d)
+				{
+					return (key.words[d >> 3] >> ((d & 7) * 8)) & 0xFF;
+				}
+
+				// LSD passes over keys [0, count) with its histograms, skipping passes where every key has the same digit.
+				// Returns whichever of keys and buffer holds the result.
+				static RadixKey* sortGroup(RadixKey *keys, RadixKey *buffer, size_t count, size_t *counts)
+				{
+					RadixKey *from = keys, *to = buffer;
+					for(size_t d = 0; count > 1 && d < RADIX_DIGITS; ++d)
+					{
+						size_t *offsets = counts + d * 256;
+						if(offsets[digit(from[0], d)] == count)
+							continue;
+						size_t total = 0;
+						for(size_t b = 0; b < 256; ++b)
+						{
+							size_t c = offsets[b];
+							offsets[b] = total;
+							total += c;
+						}
+						for(size_t i = 0; i < count; ++i)
+							to[offsets[digit(from[i], d)]++] = from[i];
+						std::swap(from, to);
+					}
+					return from;
+				}
+
+				// 2^127 + value * 10^19
+				static DecimalSortKey sortKey(const Decimal &value)
+				{
+					const uint128_t mag = value.magnitude();
+					const uint128_t offset = uint128_t(1) << 127;
+					if(value.positive_ ? mag >= offset : mag > offset)
+						DECIMAL_THROW(std::out_of_range(__FILE__ ":" STR__LINE__ " - value is outside the 128 bit sort key range"));
+					return value.positive_ ? offset + mag : offset - mag;
+				}
+			};
+		}
+
+		// Order preserving key for values within CompactDecimal's range (|value| < 17014118346046923173.1687303715884105728),
+		// throws std::out_of_range beyond it since the whole Decimal range needs 129 bits. -0 maps like 0.
+		inline DecimalSortKey sort_key(const Decimal &value)
+		{
+			return detail::SortAccess::sortKey(value);
+		}
+
+		// the scaled integer with its sign bit flipped
+		template<uint16_t FractionDigits, typename StorageT>
+		DECIMAL_CONSTEXPR typename detail::UnsignedOf<StorageT>::type sort_key(const BasicDecimal<FractionDigits, StorageT> &value)
+		{
+			typedef typename detail::UnsignedOf<StorageT>::type unsigned_type;
+			return static_cast<unsigned_type>(value.scaled()) ^ (unsigned_type(1) << (sizeof(unsigned_type) * 8 - 1));
+		}
+
+		// LSD radix sort. Values are split by sign first so the passes only see whole and fraction bytes; per sign all 16
+		// histograms are counted in one sweep and passes where every value has the same byte are skipped (e.g. the high whole
+		// bytes of prices). Stable; small ranges use std::stable_sort.
+		inline void radix_sort(Decimal *first, Decimal *last, SortOrder order = SortOrder::Ascending)
+		{
+			typedef detail::SortAccess Access;
+			const size_t count = static_cast<size_t>(last - first);
+			if(count < Access::RADIX_SORT_MIN)
+			{
+				if(order == SortOrder::Ascending)
+					std::stable_sort(first, last);
+				else
+					std::stable_sort(first, last, std::greater<Decimal>());
+				return;
+			}
+
+			const bool descending = order == SortOrder::Descending;
+			size_t groupSize[2] = {0, 0};
+			for(size_t i = 0; i < count; ++i)
+				++groupSize[Access::radixGroup(first[i], descending)];
+
+			std::vector<Access::RadixKey> keys(count), buffer(count);
+			std::vector<size_t> counts(2 * Access::RADIX_DIGITS * 256, 0);
+			size_t next[2] = {0, groupSize[0]};
+			for(size_t i = 0; i < count; ++i)
+			{
+				const bool group = Access::radixGroup(first[i], descending);
+				Access::RadixKey &key = keys[next[group]++];
+				key = Access::radixKey(first[i], descending);
+				size_t *groupCounts = &counts[group * Access::RADIX_DIGITS * 256];
+				for(size_t d = 0; d < Access::RADIX_DIGITS; ++d)
+					++groupCounts[d * 256 + Access::digit(key, d)];
+			}
+
+			size_t begin = 0;
+			for(int group = 0; group < 2; ++group)
+			{
+				const Access::RadixKey *sorted = Access::sortGroup(&keys[begin], &buffer[begin], groupSize[group], &counts[group * Access::RADIX_DIGITS * 256]);
+				for(size_t i = 0; i < groupSize[group]; ++i)
+					first[begin + i] = Access::fromRadixKey(sorted[i], group != 0, descending);
+				begin += groupSize[group];
+			}
+		}
+
+		// Sorts the smallest (Ascending) or largest (Descending) middle - first values into [first, middle), e.g. the top k prices.
+		// A few values come from a heap (std::partial_sort); past 1/128 of the range nth_element selects them in linear time and
+		// only those are radix sorted. The order of [middle, last) is unspecified.
+		inline void partial_sort(Decimal *first, Decimal *middle, Decimal *last, SortOrder order = SortOrder::Ascending)
+		{
+			if(middle == first)
+				return;
+			if(static_cast<size_t>(middle - first) * 128 < static_cast<size_t>(last - first))
+			{
+				if(order == SortOrder::Ascending)
+					std::partial_sort(first, middle, last);
+				else
+					std::partial_sort(first, middle, last, std::greater<Decimal>());
+				return;
+			}
+			if(middle != last)
+			{
+				if(order == SortOrder::Ascending)
+					std::nth_element(first, middle, last);
+				else
+					std::nth_element(first, middle, last, std::greater<Decimal>());
+			}
+			radix_sort(first, middle, order);
+		}
+	}
+}
@@ -0,0 +1,443 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+
+// Micro benchmarks for Decimal with double, int64_t scaled by 10^6 and cpp_dec_float_50 as baselines.
+// usage: bench_decimal [--text] [--filter substring] [--min-time seconds]
+// Prints one JSON document (or a table with --text), ns_per_op is the best of 3 repetitions.
+
+#include "../include/Decimal.hpp"
+#include "../include/DecimalAccumulator.hpp"
+#include "../include/DecimalColumn.hpp"
+#include "../include/DecimalMath.hpp"
+#include "../include/DecimalPackedColumn.hpp"
+
+#include <boost/multiprecision/cpp_dec_float.hpp>
+
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <sstream>
+#include <vector>
+
+using namespace tylawin::DataTypes;
+
+typedef boost::multiprecision::cpp_dec_float_50 CppDecFloat;
+
+// int64_t holding value * 10^6, the usual hand rolled fixed point
+struct ScaledInt64
+{
+	static const constexpr int64_t SCALE = 1000000;
+
+	int64_t value;
+
+	ScaledInt64 operator+(ScaledInt64 rhs) const { return ScaledInt64{value + rhs.value}; }
+	ScaledInt64 operator-(ScaledInt64 rhs) const { return ScaledInt64{value - rhs.value}; }
+	ScaledInt64 operator*(ScaledInt64 rhs) const { return ScaledInt64{value * rhs.value / SCALE}; }
+	ScaledInt64 operator/(ScaledInt64 rhs) const { return ScaledInt64{value * SCALE / rhs.value}; }
+	ScaledInt64& operator+=(ScaledInt64 rhs) { value += rhs.value; return *this; }
+	bool operator==(ScaledInt64 rhs) const { return value == rhs.value; }
+	bool operator!=(ScaledInt64 rhs) const { return value != rhs.value; }
+	bool operator<(ScaledInt64 rhs) const { return value < rhs.value; }
+	bool operator<=(ScaledInt64 rhs) const { return value <= rhs.value; }
+	bool operator>(ScaledInt64 rhs) const { return value > rhs.value; }
+	bool operator>=(ScaledInt64 rhs) const { return value >= rhs.value; }
+};
+const constexpr int64_t ScaledInt64::SCALE;
+
+template<typename T>
+struct Tag
+{ };
+
+Decimal parse(const char *str, Tag<Decimal>) { return Decimal(str); }
+double parse(const char *str, Tag<double>) { return strtod(str, nullptr); }
+CppDecFloat parse(const char *str, Tag<CppDecFloat>) { return CppDecFloat(str); }
+ScaledInt64 parse(const char *str, Tag<ScaledInt64>)
+{
+	bool negative = *str == '-';
+	if(negative)
+		++str;
+	int64_t whole = 0, fraction = 0, scale = ScaledInt64::SCALE;
+	for(; *str >= '0' && *str <= '9'; ++str)
+		whole = whole * 10 + (*str - '0');
+	if(*str == '.')
+		for(++str; *str >= '0' && *str <= '9' && scale > 1; ++str, scale /= 10)
+			fraction = fraction * 10 + (*str - '0');
+	int64_t value = whole * ScaledInt64::SCALE + fraction * scale;
+	return ScaledInt64{negative ? -value : value};
+}
+
+Decimal fromDouble(double value, Tag<Decimal>) { return Decimal(value); }
+double fromDouble(double value, Tag<double>) { return value; }
+CppDecFloat fromDouble(double value, Tag<CppDecFloat>) { return CppDecFloat(value); }
+ScaledInt64 fromDouble(double value, Tag<ScaledInt64>) { return ScaledInt64{llround(value * ScaledInt64::SCALE)}; }
+
+Decimal fromInt(int64_t value, Tag<Decimal>) { return Decimal(value); }
+double fromInt(int64_t value, Tag<double>) { return static_cast<double>(value); }
+CppDecFloat fromInt(int64_t value, Tag<CppDecFloat>) { return CppDecFloat(value); }
+ScaledInt64 fromInt(int64_t value, Tag<ScaledInt64>) { return ScaledInt64{value * ScaledInt64::SCALE}; }
+
+std::string format(const Decimal &value) { return to_string(value); }
+std::string format(const CppDecFloat &value) { return value.str(); }
+std::string format(double value)
+{
+	char buf[32];
+	snprintf(buf, sizeof(buf), "%.17g", value);
+	return buf;
+}
+std::string format(ScaledInt64 value)
+{
+	char buf[32];
+	uint64_t mag = value.value < 0 ? 0 - uint64_t(value.value) : uint64_t(value.value);
+	snprintf(buf, sizeof(buf), "%s%" PRIu64 ".%06" PRIu64, value.value < 0 ? "-" : "", mag / ScaledInt64::SCALE, mag % ScaledInt64::SCALE);
+	return buf;
+}
+
+std::ostream& operator<<(std::ostream &os, ScaledInt64 value)
+{
+	return os << format(value);
+}
+
+std::istream& operator>>(std::istream &is, ScaledInt64 &value)
+{
+	std::string str;
+	is >> str;
+	value = parse(str.c_str(), Tag<ScaledInt64>());
+	return is;
+}
+
+template<typename T>
+inline void doNotOptimize(const T &value)
+{
+#if defined(__GNUC__)
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void *sink;
+	sink = &value;
+#endif
+}
+
+struct Result
+{
+	std::string name;
+	std::string type;
+	double nsPerOp;
+	size_t ops;
+};
+
+class Bench
+{
+public:
+	Bench(std::string filter, double minTime) : filter_(std::move(filter)), minTime_(minTime)
+	{ }
+
+	// fn() performs opsPerCall operations, it is repeated until minTime_ has passed
+	template<typename Fn>
+	void run(const std::string &name, const std::string &type, size_t opsPerCall, Fn fn)
+	{
+		if(!filter_.empty() && (name + "/" + type).find(filter_) == std::string::npos)
+			return;
+		typedef std::chrono::steady_clock Clock;
+		double best = 0;
+		size_t ops = 0;
+		for(int repetition = 0; repetition < 3; ++repetition)
+		{
+			size_t calls = 0;
+			Clock::time_point start = Clock::now(), now = start;
+			do
+			{
+				fn();
+				++calls;
+				now = Clock::now();
+			} while(std::chrono::duration<double>(now - start).count() < minTime_);
+			double ns = std::chrono::duration<double, std::nano>(now - start).count() / double(calls * opsPerCall);
+			if(repetition == 0 || ns < best)
+				best = ns;
+			ops += calls * opsPerCall;
+		}
+		results_.push_back(Result{name, type, best, ops});
+	}
+
+	void printJson(std::ostream &os) const
+	{
+		os << "{\n\t\"context\": {\"simd\": \"" << simdName() << "\", \"compiler\": \"" << compilerName() << "\"},\n\t\"benchmarks\": [";
+		for(size_t i = 0; i < results_.size(); ++i)
+		{
+			const Result &r = results_[i];
+			char ns[32];
+			snprintf(ns, sizeof(ns), "%.3f", r.nsPerOp);
+			os << (i ? ",\n" : "\n") << "\t\t{\"name\": \"" << r.name << "\", \"type\": \"" << r.type << "\", \"ns_per_op\": " << ns << ", \"ops\": " << r.ops << "}";
+		}
+		os << "\n\t]\n}\n";
+	}
+
+	void printText(std::ostream &os) const
+	{
+		for(const Result &r : results_)
+		{
+			char line[128];
+			snprintf(line, sizeof(line), "%-20s %-20s %12.3f ns/op\n", r.name.c_str(), r.type.c_str(), r.nsPerOp);
+			os << line;
+		}
+	}
+
+private:
+	static const char* simdName()
+	{
+		switch(simdLevel())
+		{
+		case SimdLevel::AVX512: return "AVX512";
+		case SimdLevel::AVX2: return "AVX2";
+		default: return "Scalar";
+		}
+	}
+
+	static std::string compilerName()
+	{
+#if defined(__clang__)
+		return "clang " __clang_version__;
+#elif defined(__GNUC__)
+		return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+		return "msvc " + std::to_string(_MSC_VER);
+#else
+		return "unknown";
+#endif
+	}
+
+	std::string filter_;
+	double minTime_;
+	std::vector<Result> results_;
+};
+
+// values with at most 6 fraction digits so every type holds them exactly (double to within rounding)
+std::vector<std::string> makeInputs(size_t count, uint32_t seed)
+{
+	std::mt19937_64 rng(seed);
+	std::vector<std::string> inputs;
+	inputs.reserve(count);
+	char buf[64];
+	for(size_t i = 0; i < count; ++i)
+	{
+		uint64_t whole = rng() % 1000, fraction = rng() % 1000000;
+		snprintf(buf, sizeof(buf), "%s%" PRIu64 ".%06" PRIu64, rng() & 1 ? "-" : "", whole, fraction);
+		inputs.push_back(buf);
+	}
+	return inputs;
+}
+
+// arithmetic ops return T explicitly so expression template types (cpp_dec_float) are evaluated
+template<typename T, typename Op>
+void benchBinary(Bench &bench, const char *name, const char *type, const std::vector<T> &a, const std::vector<T> &b, Op op)
+{
+	bench.run(name, type, a.size(), [&]() {
+		for(size_t i = 0; i < a.size(); ++i)
+			doNotOptimize(op(a[i], b[i]));
+	});
+}
+
+template<typename T>
+void benchType(Bench &bench, const char *type, const std::vector<std::string> &inputs, const std::vector<std::string> &divisors, const std::vector<std::string> &sumInputs)
+{
+	const size_t n = inputs.size();
+	std::vector<T> a, b, sumValues;
+	std::vector<double> doubles;
+	std::vector<int64_t> ints;
+	for(size_t i = 0; i < n; ++i)
+	{
+		a.push_back(parse(inputs[i].c_str(), Tag<T>()));
+		b.push_back(parse(divisors[i].c_str(), Tag<T>()));
+		doubles.push_back(strtod(inputs[i].c_str(), nullptr));
+		ints.push_back(strtoll(inputs[i].c_str(), nullptr, 10));
+	}
+	for(const std::string &str : sumInputs)
+		sumValues.push_back(parse(str.c_str(), Tag<T>()));
+
+	bench.run("from_string", type, n, [&]() {
+		for(size_t i = 0; i < n; ++i)
+			doNotOptimize(parse(inputs[i].c_str(), Tag<T>()));
+	});
+	bench.run("from_double", type, n, [&]() {
+		for(size_t i = 0; i < n; ++i)
+			doNotOptimize(fromDouble(doubles[i], Tag<T>()));
+	});
+	bench.run("from_int", type, n, [&]() {
+		for(size_t i = 0; i < n; ++i)
+			doNotOptimize(fromInt(ints[i], Tag<T>()));
+	});
+	bench.run("to_string", type, n, [&]() {
+		for(size_t i = 0; i < n; ++i)
+			doNotOptimize(format(a[i]));
+	});
+
+	benchBinary(bench, "add", type, a, b, [](const T &l, const T &r) -> T { return l + r; });
+	benchBinary(bench, "subtract", type, a, b, [](const T &l, const T &r) -> T { return l - r; });
+	benchBinary(bench, "multiply", type, a, b, [](const T &l, const T &r) -> T { return l * r; });
+	benchBinary(bench, "divide", type, a, b, [](const T &l, const T &r) -> T { return l / r; });
+	benchBinary(bench, "equal", type, a, b, [](const T &l, const T &r) { return l == r; });
+	benchBinary(bench, "not_equal", type, a, b, [](const T &l, const T &r) { return l != r; });
+	benchBinary(bench, "less", type, a, b, [](const T &l, const T &r) { return l < r; });
+	benchBinary(bench, "less_equal", type, a, b, [](const T &l, const T &r) { return l <= r; });
+	benchBinary(bench, "greater", type, a, b, [](const T &l, const T &r) { return l > r; });
+	benchBinary(bench, "greater_equal", type, a, b, [](const T &l, const T &r) { return l >= r; });
+
+	bench.run("ostream", type, n, [&]() {
+		std::ostringstream os;
+		for(size_t i = 0; i < n; ++i)
+			os << a[i] << ' ';
+		doNotOptimize(os.tellp());
+	});
+	std::string text;
+	for(const std::string &str : inputs)
+		text += str + ' ';
+	bench.run("istream", type, n, [&]() {
+		std::istringstream is(text);
+		T value = T();
+		for(size_t i = 0; i < n; ++i)
+		{
+			is >> value;
+			doNotOptimize(value);
+		}
+	});
+
+	bench.run("sum_1m", type, sumValues.size(), [&]() {
+		T sum = T();
+		for(const T &value : sumValues)
+			sum += value;
+		doNotOptimize(sum);
+	});
+}
+
+int main(int argc, char **argv)
+{
+	bool text = false;
+	std::string filter;
+	double minTime = 0.05;
+	for(int i = 1; i < argc; ++i)
+	{
+		if(strcmp(argv[i], "--text") == 0)
+			text = true;
+		else if(strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+			filter = argv[++i];
+		else if(strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+			minTime = strtod(argv[++i], nullptr);
+		else
+		{
+			std::cerr << "usage: " << argv[0] << " [--text] [--filter substring] [--min-time seconds]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	const std::vector<std::string> inputs = makeInputs(4096, 1);
+	std::vector<std::string> divisors = makeInputs(inputs.size(), 2);
+	for(std::string &str : divisors)// keep divisors away from zero for every type
+		str.insert(str[0] == '-' ? 1 : 0, "1");
+	const std::vector<std::string> sumInputs = makeInputs(1000000, 3);
+
+	Bench bench(filter, minTime);
+	try
+	{
+		benchType<Decimal>(bench, "Decimal", inputs, divisors, sumInputs);
+		benchType<double>(bench, "double", inputs, divisors, sumInputs);
+		benchType<ScaledInt64>(bench, "int64_scaled", inputs, divisors, sumInputs);
+		benchType<CppDecFloat>(bench, "cpp_dec_float_50", inputs, divisors, sumInputs);
+
+		std::vector<Decimal> sumValues;
+		for(const std::string &str : sumInputs)
+			sumValues.push_back(Decimal(str));
+		bench.run("sum_1m", "DecimalAccumulator", sumValues.size(), [&]() {
+			DecimalAccumulator sum;
+			sum.add(sumValues.data(), sumValues.size());
+			doNotOptimize(sum.result());
+		});
+
+		std::vector<Decimal> quantized(sumValues.size());
+		bench.run("quantize_2", "Decimal", sumValues.size(), [&]() {
+			quantize(sumValues.data(), sumValues.size(), quantized.data(), 2, RoundingMode::HalfEven);
+			doNotOptimize(quantized.back());
+		});
+
+		// packed column decode, to scaled integers and back to Decimals
+		std::vector<Decimal> prices;
+		for(size_t i = 0; i < sumValues.size(); ++i)
+			prices.push_back(Decimal(int64_t(1000000 + (i * 7919) % 20000)) / 100);
+		const DecimalPackedColumn packed(prices.begin(), prices.end());
+		std::vector<int64_t> scaled(DecimalPackedColumn::BLOCK_SIZE);
+		bench.run("packed_decode", "int64_scaled", packed.size(), [&]() {
+			for(size_t block = 0; block < packed.blockCount(); ++block)
+				packed.decodeScaled(block, scaled.data());
+			doNotOptimize(scaled.back());
+		});
+		bench.run("packed_decode", "Decimal", packed.size(), [&]() {
+			for(size_t block = 0; block < packed.blockCount(); ++block)
+				packed.decode(block, prices.data() + block * DecimalPackedColumn::BLOCK_SIZE);
+			doNotOptimize(prices.back());
+		});
+
+		std::string text;
+		for(const std::string &str : inputs)
+			text += str + ' ';
+		std::vector<Decimal> values;
+		values.reserve(inputs.size());
+		bench.run("istream", "read_decimals", inputs.size(), [&]() {
+			std::istringstream is(text);
+			values.clear();
+			read_decimals(is, std::back_inserter(values));
+			doNotOptimize(values.back());
+		});
+
+		// fixed point math against the double round trip it replaces
+		std::vector<Decimal> mathValues;
+		for(int i = 1; i <= 4096; ++i)
+			mathValues.push_back(Decimal(i) / 1000);
+		bench.run("exp", "Decimal", mathValues.size(), [&]() {
+			for(const Decimal &value : mathValues)
+				doNotOptimize(exp(value));
+		});
+		bench.run("exp", "double_round_trip", mathValues.size(), [&]() {
+			for(const Decimal &value : mathValues)
+				doNotOptimize(Decimal(static_cast<long double>(std::exp(value.asDouble()))));
+		});
+		bench.run("log", "Decimal", mathValues.size(), [&]() {
+			for(const Decimal &value : mathValues)
+				doNotOptimize(log(value));
+		});
+		bench.run("sqrt", "Decimal", mathValues.size(), [&]() {
+			for(const Decimal &value : mathValues)
+				doNotOptimize(sqrt(value));
+		});
+		bench.run("pow_12", "Decimal", mathValues.size(), [&]() {
+			for(const Decimal &value : mathValues)
+				doNotOptimize(pow(value, 12));
+		});
+	}
+	catch(const std::exception &e)
+	{
+		std::cerr << "error: " << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	if(text)
+		bench.printText(std::cout);
+	else
+		bench.printJson(std::cout);
+	return EXIT_SUCCESS;
+}
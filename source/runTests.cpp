@@ -15,13 +15,35 @@ limitations under the License.
 */
 
 #include "../include/Decimal.hpp"
+#include "../include/DecimalAccumulator.hpp"
+#include "../include/DecimalBinary.hpp"
+#include "../include/DecimalChecked.hpp"
+#include "../include/DecimalColumn.hpp"
+#include "../include/DecimalCsv.hpp"
+#include "../include/DecimalDot.hpp"
+#include "../include/DecimalExpression.hpp"
+#include "../include/DecimalGroupBy.hpp"
+#include "../include/DecimalInstrumentation.hpp"
+#include "../include/DecimalMath.hpp"
+#include "../include/DecimalPackedColumn.hpp"
+#include "../include/DecimalParallel.hpp"
+#include "../include/DecimalSort.hpp"
 
+#include <algorithm>
 #include <assert.h>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
+#include <iterator>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #define STR_ASSERT(left, oper, right) if(!((left) oper (right))) throw std::runtime_error(__FILE__ ":" STR__LINE__ "- expr(" #left " " #oper " " #right ")  vals(" +(left)+ " " #oper " " +(right)+ ")")
 #define DEC_ASSERT(left, oper, right) if(!((left) oper (right))) throw std::runtime_error(__FILE__ ":" STR__LINE__ "- expr(" #left " " #oper " " #right ")  vals(" +to_string(left)+ " " #oper " " +to_string(right)+ ")")
 
+void decimalSecondUnitTests();// runTestsSecondUnit.cpp
+
 void decimalUnitTests()
 {
 	using namespace tylawin::DataTypes;
@@ -31,6 +53,30 @@ void decimalUnitTests()
 	STR_ASSERT( to_string(Decimal(-222)),       ==, std::string("-222") );
 	STR_ASSERT( to_string(Decimal(222.222L)),   ==, std::string("222.222")  );
 	STR_ASSERT( to_string(Decimal(-222.222L)),  ==, std::string("-222.222") );
+	STR_ASSERT( to_string(Decimal(0.1)),        ==, std::string("0.1")      );
+	STR_ASSERT( to_string(Decimal(-0.1f)),      ==, std::string("-0.1")     );
+	STR_ASSERT( to_string(Decimal(-0.0)),       ==, std::string("0")        );
+	STR_ASSERT( to_string(Decimal(0.9999999999999999)),  ==, std::string("1")  );
+	STR_ASSERT( to_string(Decimal(1e-20)),      ==, std::string("0")        );
+	STR_ASSERT( to_string(Decimal(1234567.125f)),        ==, std::string("1234567.125")  );
+	STR_ASSERT( to_string(Decimal(123456.7f)),           ==, std::string("123457")  );
+	STR_ASSERT( to_string(Decimal(12345678901234567.0)), ==, std::string("12345678901234568")  );
+	STR_ASSERT( to_string(Decimal(18446744073709549568.0)), ==, std::string("18446744073709549568") );
+	{
+		Decimal d;
+		d = -222.222L;
+		DEC_ASSERT( d, ==, Decimal(-222.222L) );
+		assert(to_double(Decimal("-1.1")) == -1.1 && to_float(Decimal("-1.1")) == -1.1f && Decimal("-1.1").asDouble() == -1.1L && "to_double sign");
+		assert(to_double(Decimal("0.1")) == 0.1 && to_double(Decimal("0.0000000000000000001")) == 1e-19 && to_double(Decimal(0)) == 0.0 && "to_double rounding");
+		assert(to_double(Decimal("18446744073709551615.9999999999999999999")) == 18446744073709551616.0 && "to_double max");
+		assert(to_double(Decimal("9007199254740993")) == 9007199254740992.0 && to_double(Decimal("9007199254740993.0000000000000000001")) == 9007199254740994.0 && "to_double ties to even");
+		bool threw = false;
+		try { Decimal tmp(std::numeric_limits<double>::quiet_NaN()); } catch(const std::invalid_argument &) { threw = true; }
+		assert(threw && "double constructor nan");
+		threw = false;
+		try { Decimal tmp(18446744073709551616.0); } catch(const std::out_of_range &) { threw = true; }
+		assert(threw && "double constructor out_of_range");
+	}
 	STR_ASSERT( to_string(Decimal("0")),        ==, std::string("0")    );
 	STR_ASSERT( to_string(Decimal("1")),        ==, std::string("1")    );
 	STR_ASSERT( to_string(Decimal("-1")),       ==, std::string("-1")   );
@@ -42,6 +88,52 @@ void decimalUnitTests()
 	STR_ASSERT( to_string(Decimal("9999999999.99999999")),  ==, std::string("9999999999.99999999")  );
 	STR_ASSERT( to_string(Decimal("18446744073709551615.9999999999999999999")),  ==, std::string("18446744073709551615.9999999999999999999")  );
 	STR_ASSERT( to_string(Decimal("-18446744073709551615.9999999999999999999")), ==, std::string("-18446744073709551615.9999999999999999999") );
+	STR_ASSERT( to_string(Decimal("")),         ==, std::string("0")    );
+	STR_ASSERT( to_string(Decimal("-0")),       ==, std::string("0")    );
+	STR_ASSERT( to_string(Decimal("1.")),       ==, std::string("1")    );
+	STR_ASSERT( to_string(Decimal("000000000000000000000012.3400")),  ==, std::string("12.34") );
+	STR_ASSERT( to_string(Decimal("12345678901234567.12345678901234567899999")), ==, std::string("12345678901234567.1234567890123456789") );
+
+	{
+		Decimal d("7");
+		const char str[] = "-12.5abc";
+		from_chars_result res = Decimal::from_chars(str, str + sizeof(str) - 1, d);
+		assert(res.ec == std::errc() && res.ptr == str + 5 && d == Decimal("-12.5") && "from_chars prefix");
+		res = Decimal::from_chars(str + 5, str + sizeof(str) - 1, d);
+		assert(res.ec == std::errc::invalid_argument && res.ptr == str + 5 && d == Decimal("-12.5") && "from_chars invalid");
+		const char big[] = "18446744073709551616";
+		res = Decimal::from_chars(big, big + sizeof(big) - 1, d);
+		assert(res.ec == std::errc::result_out_of_range && d == Decimal("-12.5") && "from_chars out of range");
+
+		const char *invalid[] = {"-", ".", "-.", "1.2.3", "1-2", "+1", " 1", "1e5"};
+		for(const char *s : invalid)
+		{
+			bool threw = false;
+			try { Decimal tmp(s); } catch(const std::invalid_argument &) { threw = true; }
+			assert(threw && "string constructor invalid_argument");
+		}
+		bool threw = false;
+		try { Decimal tmp(big); } catch(const std::out_of_range &) { threw = true; }
+		assert(threw && "string constructor out_of_range");
+	}
+
+	STR_ASSERT( to_string(Decimal("12.345"), 0),     ==, std::string("12")        );
+	STR_ASSERT( to_string(Decimal("12.345"), 2),     ==, std::string("12.34")     );
+	STR_ASSERT( to_string(Decimal("-12.345"), 5),    ==, std::string("-12.34500") );
+	STR_ASSERT( to_string(Decimal("12"), 3),         ==, std::string("12.000")    );
+	STR_ASSERT( to_string(Decimal("0.0000000000000000001"), 21), ==, std::string("0.000000000000000000100") );
+	STR_ASSERT( to_string(Decimal("100.0000000000000000001")),   ==, std::string("100.0000000000000000001") );
+	STR_ASSERT( to_string(Decimal("100.1000000000000000000")),   ==, std::string("100.1") );
+
+	{
+		char buf[8];
+		to_chars_result res = to_chars(buf, buf + sizeof(buf), Decimal("-123.25"));
+		assert(res.ec == std::errc() && std::string(buf, res.ptr) == "-123.25" && "to_chars");
+		res = to_chars(buf, buf + 6, Decimal("-123.25"));
+		assert(res.ec == std::errc::value_too_large && res.ptr == buf + 6 && "to_chars too small");
+		res = to_chars(buf, buf + sizeof(buf), Decimal("-123.25"), 1);
+		assert(res.ec == std::errc() && std::string(buf, res.ptr) == "-123.2" && "to_chars precision");
+	}
 
 	DEC_ASSERT( Decimal("0"),    ==, Decimal("0")    );
 	DEC_ASSERT( Decimal("1"),    ==, Decimal("1")    );
@@ -131,6 +223,7 @@ void decimalUnitTests()
 	STR_ASSERT( to_string(Decimal("4.4444444444444444444") + Decimal("-2.2222222222222222222")), ==, std::string("2.2222222222222222222") );
 	STR_ASSERT( to_string(Decimal("-2.2222222222222222222") + Decimal("2")),  ==, std::string("-0.2222222222222222222") );
 	STR_ASSERT( to_string(Decimal("-4.4444444444444444444") + Decimal("-2")), ==, std::string("-6.4444444444444444444") );
+	STR_ASSERT( to_string(Decimal("0.9999999999999999999") + Decimal("0.9999999999999999999")), ==, std::string("1.9999999999999999998") );
 
 	STR_ASSERT( to_string(Decimal("0") - Decimal("0")),       ==, std::string("0")    );
 	STR_ASSERT( to_string(Decimal("1") - Decimal("0")),       ==, std::string("1")    );
@@ -204,6 +297,29 @@ void decimalUnitTests()
 	STR_ASSERT( to_string(Decimal("4.4444444444444444444") / Decimal("-2")),  ==, std::string("-2.2222222222222222222") );
 	STR_ASSERT( to_string(Decimal("-2.2222222222222222222") / Decimal("2")),  ==, std::string("-1.1111111111111111111") );
 	STR_ASSERT( to_string(Decimal("-4.4444444444444444444") / Decimal("-2")), ==, std::string("2.2222222222222222222")  );
+	STR_ASSERT( to_string(Decimal("100000") / Decimal("12345678901234.5")),    ==, std::string("0.0000000081000000729") );
+	STR_ASSERT( to_string(Decimal("18446744073709551615.9999999999999999999") / Decimal("3.5")), ==, std::string("5270498306774157604.5714285714285714285") );
+	STR_ASSERT( to_string(Decimal("9.9999999999999999999") * Decimal("9.9999999999999999999")),  ==, std::string("99.999999999999999998") );
+	STR_ASSERT( to_string(Decimal("123456789.987654321") * Decimal("-98765.4321")),  ==, std::string("-12193263208809.6326789971041") );
+	STR_ASSERT( to_string(Decimal("-0.0000000001") * Decimal("0.0000000001")),      ==, std::string("0") );
+	STR_ASSERT( to_string(Decimal("-0.0000000001") / Decimal("100000000000")),      ==, std::string("0") );
+	assert(detail::reciprocal(10000000000000000000ULL) == 0xD83C94FB6D2AC34AULL && "fractionDenominator_ reciprocal");
+
+	{
+		constexpr Decimal tick("0.0001");
+		constexpr Decimal fee = 2.5_dec;
+		static_assert(tick == 0.0001_dec && tick < fee && -fee < tick, "constexpr compare");
+#if defined(DECIMAL_NATIVE_INT128) || !defined(DECIMAL_EXPRESSION_TEMPLATES)
+		static_assert(Decimal(3) + Decimal(-5) == -2_dec && fee - tick == 2.4999_dec, "constexpr add/sub");
+#endif
+		static_assert(Decimal(-7) == -7_dec && Decimal(uint64_t(18446744073709551615ULL)) == 18446744073709551615_dec, "constexpr int constructors");
+#ifdef DECIMAL_NATIVE_INT128
+		static_assert(fee * tick == 0.00025_dec && 1_dec / 3_dec == 0.3333333333333333333_dec && -4_dec / 0.5_dec == -8_dec, "constexpr mul/div");
+		static_assert(CompactDecimal("1.5") * CompactDecimal(-2) == CompactDecimal(-3), "constexpr CompactDecimal");
+#endif
+		STR_ASSERT( to_string(123.45_dec),  ==, std::string("123.45") );
+		STR_ASSERT( to_string(-.5_dec),     ==, std::string("-0.5")   );
+	}
 
 	Decimal t1, t2;
 
@@ -222,6 +338,1046 @@ void decimalUnitTests()
 	ss3 << t1;
 	ss3 >> t2;
 	assert(t1 == t2 && "istream ostream test3");
+
+	std::istringstream ss4(" -1.5\t.25 +7. 0.12345678901234567891234\n-0 42");
+	const char *read[] = {"-1.5", "0.25", "7", "0.1234567890123456789", "0", "42"};
+	for(const char *expected : read)
+	{
+		assert(ss4 >> t2 && "istream whitespace separated");
+		DEC_ASSERT( t2, ==, Decimal(expected) );
+	}
+	assert(ss4.eof() && !ss4.fail() && "istream last value at end of stream");
+	assert(!(ss4 >> t2) && "istream past the end");
+
+	std::istringstream ss5("1 2.5\n -3.75 x 4");
+	std::vector<Decimal> values;
+	read_decimals(ss5, std::back_inserter(values));
+	assert(values.size() == 3 && values[2] == Decimal("-3.75") && ss5.fail() && "read_decimals stops at text that is not a Decimal");
+	ss5.clear();
+	std::string rest;
+	ss5 >> rest;
+	assert(rest == "x" && "read_decimals leaves the failing text");
+	std::istringstream ss6("99999999999999999999 1");
+	assert(!(ss6 >> t2) && "istream whole part overflow");
+	std::istringstream ss7("-. 1");
+	bool threw = false;
+	try { ss7 >> t2; } catch(const std::invalid_argument &) { threw = true; }
+	assert(threw && "istream point without digits");
+}
+
+#ifdef DECIMAL_NATIVE_INT128
+void compactDecimalUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	static_assert(sizeof(CompactDecimal) == 16, "CompactDecimal size");
+	STR_ASSERT( to_string(CompactDecimal("0")),        ==, std::string("0")     );
+	STR_ASSERT( to_string(CompactDecimal("-1.25")),    ==, std::string("-1.25") );
+	STR_ASSERT( to_string(CompactDecimal(-7)),         ==, std::string("-7")    );
+	STR_ASSERT( to_string(CompactDecimal("17014118346046923173.1687303715884105727")),  ==, std::string("17014118346046923173.1687303715884105727")  );
+	STR_ASSERT( to_string(CompactDecimal("-17014118346046923173.1687303715884105728")), ==, std::string("-17014118346046923173.1687303715884105728") );
+
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.0000001", "1.9999999999999999999", "-1.9999999999999999999",
+		"5.55555555", "-6", "7.5555", "3.3333", "123456789.987654321", "-98765.4321", "429496729.6000000001", "-1844674407.3709551615"};
+	for(const char *l : values)
+	{
+		for(const char *r : values)
+		{
+			Decimal dl(l), dr(r);
+			CompactDecimal cl(l), cr(r);
+			DEC_ASSERT( Decimal(cl + cr), ==, dl + dr );
+			DEC_ASSERT( Decimal(cl - cr), ==, dl - dr );
+			DEC_ASSERT( Decimal(cl * cr), ==, dl * dr );
+			if(dr != Decimal(0))
+				DEC_ASSERT( Decimal(cl / cr), ==, dl / dr );
+			assert((cl < cr) == (dl < dr) && (cl == cr) == (dl == dr) && (cl >= cr) == (dl >= dr) && "CompactDecimal compare");
+			assert(cl.whole() == CompactDecimal(cl.whole()).whole() && (cl.positive() == (dl >= Decimal(0))) && "CompactDecimal views");
+		}
+	}
+	DEC_ASSERT( Decimal(CompactDecimal("12.5").whole()),    ==, Decimal(12) );
+	DEC_ASSERT( Decimal(CompactDecimal("-12.5").fraction()), ==, Decimal(uint64_t(5000000000000000000ULL)) );
+
+	bool threw = false;
+	try { CompactDecimal tmp(Decimal("17014118346046923173.1687303715884105728")); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "CompactDecimal out_of_range");
+}
+#endif
+
+void decimal64UnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	static_assert(sizeof(Decimal64) == 8, "Decimal64 size");
+#ifdef DECIMAL_NATIVE_INT128
+	static_assert(Decimal64("1.5") * Decimal64(-2) == Decimal64(-3) && Decimal64("0.00000001") > Decimal64(0), "constexpr Decimal64");
+#endif
+	STR_ASSERT( to_string(Decimal64("123.456789129")),  ==, std::string("123.45678912") );
+	STR_ASSERT( to_string(Decimal64("-0.5")),           ==, std::string("-0.5")         );
+	STR_ASSERT( to_string(Decimal64("92233720368.54775807")),  ==, std::string("92233720368.54775807")  );
+	STR_ASSERT( to_string(Decimal64("-92233720368.54775808")), ==, std::string("-92233720368.54775808") );
+
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.0001", "1.99999999", "-1.99999999", "5.55555555", "-6", "7.5555", "3.3333", "12345.6789", "-98765.4321"};
+	for(const char *l : values)
+	{
+		for(const char *r : values)
+		{
+			Decimal dl(l), dr(r);
+			Decimal64 sl(l), sr(r);
+			DEC_ASSERT( Decimal(sl + sr), ==, dl + dr );
+			DEC_ASSERT( Decimal(sl - sr), ==, dl - dr );
+			DEC_ASSERT( Decimal(sl * sr), ==, Decimal(decimal_cast<Decimal64>(dl * dr)) );
+			if(dr != Decimal(0))
+				DEC_ASSERT( Decimal(sl / sr), ==, Decimal(decimal_cast<Decimal64>(dl / dr)) );
+			assert((sl < sr) == (dl < dr) && (sl == sr) == (dl == dr) && "Decimal64 compare");
+		}
+	}
+
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(Decimal("1.234567885"), RoundingMode::Truncate)),  ==, std::string("1.23456788") );
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(Decimal("1.234567885"), RoundingMode::HalfUp)),    ==, std::string("1.23456789") );
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(Decimal("1.234567885"), RoundingMode::HalfEven)),  ==, std::string("1.23456788") );
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(Decimal("1.234567895"), RoundingMode::HalfEven)),  ==, std::string("1.2345679")  );
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(Decimal("-1.234567881"), RoundingMode::Floor)),    ==, std::string("-1.23456789") );
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(Decimal("-1.234567881"), RoundingMode::Ceiling)),  ==, std::string("-1.23456788") );
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(Decimal("1.234567881"), RoundingMode::Ceiling)),   ==, std::string("1.23456789")  );
+	STR_ASSERT( to_string(decimal_cast<Decimal>(Decimal64("-7.25"))),  ==, std::string("-7.25") );
+#ifdef DECIMAL_NATIVE_INT128
+	STR_ASSERT( to_string(decimal_cast<CompactDecimal>(Decimal64("-7.25"))),  ==, std::string("-7.25") );
+	STR_ASSERT( to_string(decimal_cast<Decimal64>(CompactDecimal("-7.123456789"), RoundingMode::HalfUp)),  ==, std::string("-7.12345679") );
+#endif
+
+	bool threw = false;
+	try { Decimal64 tmp(uint64_t(92233720369ULL)); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "Decimal64 whole out_of_range");
+	threw = false;
+	try { Decimal64 tmp(Decimal("92233720368.54775808")); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "Decimal64 conversion out_of_range");
+}
+
+void decimalQuantizeUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// 8 digits must match decimal_cast to Decimal64 in every mode
+	const RoundingMode modes[] = {RoundingMode::Truncate, RoundingMode::HalfUp, RoundingMode::HalfEven, RoundingMode::Floor, RoundingMode::Ceiling};
+	const char *values[] = {"0", "1", "-1", "0.000000005", "-0.000000005", "0.000000015", "-0.000000025", "0.0000000050000000001", "2.999999995",
+		"-2.999999999", "1.23456785", "-1.23456785", "3.3333333333333333333", "-98765.4321", "92233720368.5477580"};
+	for(RoundingMode mode : modes)
+	{
+		std::vector<Decimal> in, out(sizeof(values) / sizeof(values[0]));
+		for(const char *value : values)
+			in.push_back(Decimal(value));
+		quantize(in.data(), in.size(), out.data(), 8, mode);
+		for(size_t i = 0; i < in.size(); ++i)
+		{
+			DEC_ASSERT( quantize(in[i], 8, mode), ==, Decimal(decimal_cast<Decimal64>(in[i], mode)) );
+			DEC_ASSERT( out[i], ==, quantize(in[i], 8, mode) );
+		}
+	}
+
+	// ties, carries into the whole part and whole digits
+	DEC_ASSERT( quantize(Decimal("2.5"), 0, RoundingMode::HalfEven), ==, Decimal(2) );
+	DEC_ASSERT( quantize(Decimal("3.5"), 0, RoundingMode::HalfEven), ==, Decimal(4) );
+	DEC_ASSERT( quantize(Decimal("-2.5"), 0, RoundingMode::HalfUp), ==, Decimal(-3) );
+	DEC_ASSERT( quantize(Decimal("0.0000000000000000001"), 0, RoundingMode::Ceiling), ==, Decimal(1) );
+	DEC_ASSERT( quantize(Decimal("-0.0000000000000000001"), 2, RoundingMode::Floor), ==, Decimal("-0.01") );
+	DEC_ASSERT( quantize(Decimal("1.995"), 2, RoundingMode::HalfEven), ==, Decimal(2) );
+	DEC_ASSERT( quantize(Decimal("1.985"), 2, RoundingMode::HalfEven), ==, Decimal("1.98") );
+	DEC_ASSERT( quantize(Decimal("-1.23456"), 3, RoundingMode::Truncate), ==, Decimal("-1.234") );
+	DEC_ASSERT( quantize(Decimal("1.2345678901234567891"), 19, RoundingMode::Ceiling), ==, Decimal("1.2345678901234567891") );
+	DEC_ASSERT( quantize(Decimal(15), -1, RoundingMode::HalfEven), ==, Decimal(20) );
+	DEC_ASSERT( quantize(Decimal(25), -1, RoundingMode::HalfEven), ==, Decimal(20) );
+	DEC_ASSERT( quantize(Decimal("25.0000000000000000001"), -1, RoundingMode::HalfEven), ==, Decimal(30) );
+	DEC_ASSERT( quantize(Decimal(-1234), -2, RoundingMode::Ceiling), ==, Decimal(-1200) );
+	DEC_ASSERT( quantize(Decimal("9999999999999999999"), -19, RoundingMode::HalfUp), ==, Decimal("10000000000000000000") );
+	assert(to_string(quantize(Decimal("-0.001"), 2, RoundingMode::Truncate)) == "0" && "quantize -0");
+
+#ifdef DECIMAL_NATIVE_INT128
+	static_assert(quantize(2.675_dec, 2, RoundingMode::HalfUp) == 2.68_dec, "constexpr quantize");
+#endif
+
+	bool threw = false;
+	try { quantize(Decimal("18446744073709551615.5"), 0, RoundingMode::HalfUp); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "quantize overflow");
+	threw = false;
+	try { quantize(Decimal("15000000000000000000"), -19, RoundingMode::HalfUp); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "quantize whole overflow");
+	threw = false;
+	try { quantize(Decimal(1), -20, RoundingMode::HalfUp); } catch(const std::invalid_argument &) { threw = true; }
+	assert(threw && "quantize digits");
+}
+
+void decimalMixedIntegerUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// every operator must match the Decimal operator on the converted integer, including wrap around and truncation
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.5", "-0.0000001", "1.9999999999999999999", "-1.8446744073709551615", "3.3333",
+		"123456789.987654321", "-98765.4321", "-7", "7", "18446744073709551615.9999999999999999999", "-18446744073709551615.9999999999999999999"};
+	const int64_t signedValues[] = {0, 1, -1, 2, -3, 7, -7, 1000, INT64_MAX, INT64_MIN};
+	const uint64_t unsignedValues[] = {0, 1, 3, 7, 10000000000000000000ULL, UINT64_MAX};
+	for(const char *str : values)
+	{
+		const Decimal d(str);
+		for(int64_t n : signedValues)
+		{
+			const Decimal dn(n);
+			DEC_ASSERT( d + n, ==, d + dn );
+			DEC_ASSERT( d - n, ==, d - dn );
+			DEC_ASSERT( d * n, ==, d * dn );
+			DEC_ASSERT( n + d, ==, dn + d );
+			DEC_ASSERT( n - d, ==, dn - d );
+			DEC_ASSERT( n * d, ==, dn * d );
+			if(n != 0)
+				DEC_ASSERT( d / n, ==, d / dn );
+			if(d != Decimal(0))
+				DEC_ASSERT( n / d, ==, dn / d );
+			assert((d == n) == (d == dn) && (d != n) == (d != dn) && (d < n) == (d < dn) && (d > n) == (d > dn) && "mixed int64_t compare");
+			assert((d <= n) == (d <= dn) && (d >= n) == (d >= dn) && (n < d) == (dn < d) && (n >= d) == (dn >= d) && "mixed int64_t compare");
+		}
+		for(uint64_t n : unsignedValues)
+		{
+			const Decimal dn(n);
+			DEC_ASSERT( d + n, ==, d + dn );
+			DEC_ASSERT( d - n, ==, d - dn );
+			DEC_ASSERT( d * n, ==, d * dn );
+			if(n != 0)
+				DEC_ASSERT( d / n, ==, d / dn );
+			assert((d == n) == (d == dn) && (d < n) == (d < dn) && (d > n) == (d > dn) && (n <= d) == (dn <= d) && "mixed uint64_t compare");
+		}
+	}
+
+	// smaller and differently named integer types pick the signed or unsigned path by their signedness
+	Decimal lot("0.25");
+	lot *= static_cast<short>(-3);
+	DEC_ASSERT( lot, ==, Decimal("-0.75") );
+	DEC_ASSERT( Decimal("10.5") / -4, ==, Decimal("-2.625") );
+	DEC_ASSERT( Decimal(1) - static_cast<unsigned char>(3), ==, Decimal(-2) );
+	DEC_ASSERT( Decimal("2.5") + 1LL, ==, Decimal("3.5") );
+	assert(Decimal("-0.5") < 0 && 0 > Decimal("-0.5") && Decimal("2.0000000000000000001") > 2 && !(Decimal(2) > 2U) && "mixed compare");
+	assert(to_string(Decimal("-2.5") + 2 + Decimal("0.5")) == "0" && to_string(Decimal(3) * -0) == "0" && "mixed -0");
+
+#ifdef DECIMAL_NATIVE_INT128
+	static_assert(1.5_dec * 3 == 4.5_dec && 1.5_dec + 3 == 4.5_dec && 1.5_dec - 3 == -1.5_dec && 4.5_dec / 3 == 1.5_dec && 1.5_dec < 2, "constexpr mixed integer operators");
+#endif
+
+	bool threw = false;
+	try { Decimal q(1); q /= 0; } catch(const std::runtime_error &) { threw = true; }
+	assert(threw && "mixed division by zero");
+}
+
+void decimalCheckedUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	Decimal max("18446744073709551615.9999999999999999999"), result;
+	clear_decimal_status();
+	assert(checked_add(Decimal("1.5"), Decimal("-2.25"), result) == DecimalStatus::Ok && result == Decimal("-0.75") && "checked_add");
+	assert(checked_sub(Decimal("-1.5"), Decimal("2.25"), result) == DecimalStatus::Ok && result == Decimal("-3.75") && "checked_sub");
+	assert(checked_mul(Decimal("123456789.987654321"), Decimal("-98765.4321"), result) == DecimalStatus::Ok && result == Decimal("-12193263208809.6326789971041") && "checked_mul");
+	assert(checked_div(Decimal("7.5"), Decimal("-2"), result) == DecimalStatus::Ok && result == Decimal("-3.75") && "checked_div");
+	assert(decimal_status() == DecimalStatus::Ok && "no flags raised");
+
+	// overflow wraps like the operators, the flags stay set until cleared
+	assert(checked_add(max, Decimal("0.0000000000000000001"), result) == DecimalStatus::Overflow && result == max + Decimal("0.0000000000000000001") && "checked_add overflow");
+	assert(checked_sub(-max, Decimal(1), result) == DecimalStatus::Overflow && "checked_sub overflow");
+	assert(checked_sub(-max, Decimal(-1), result) == DecimalStatus::Ok && "checked_sub no overflow");
+	assert(checked_mul(Decimal("4294967296"), Decimal("4294967296"), result) == DecimalStatus::Overflow && "checked_mul overflow");
+	assert(checked_mul(Decimal("4294967296"), Decimal("-4294967295.9999999999"), result) == DecimalStatus::Ok && result == Decimal("4294967296") * Decimal("-4294967295.9999999999") && "checked_mul no overflow");
+	assert(checked_mul(Decimal("0.0000000001"), Decimal("0.0000000001"), result) == DecimalStatus::Inexact && result == Decimal(0) && "checked_mul inexact");
+	assert(checked_div(max, Decimal("0.5"), result) == DecimalStatus::Overflow && result == max / Decimal("0.5") && "checked_div overflow");
+	assert(checked_div(Decimal(1), Decimal(3), result) == DecimalStatus::Inexact && result == Decimal("0.3333333333333333333") && "checked_div inexact");
+	assert(checked_div(Decimal(1), Decimal(0), result) == DecimalStatus::DivisionByZero && result == Decimal(0) && "checked_div by zero");
+	assert(decimal_status() == (DecimalStatus::Overflow | DecimalStatus::Inexact | DecimalStatus::DivisionByZero) && "sticky flags");
+	assert(clear_decimal_status(DecimalStatus::Inexact) == (DecimalStatus::Overflow | DecimalStatus::Inexact | DecimalStatus::DivisionByZero) && "clear returns previous");
+	assert(decimal_status() == (DecimalStatus::Overflow | DecimalStatus::DivisionByZero) && "clear mask");
+	clear_decimal_status();
+
+	const std::string strings[] = {"1.5", "1.12345678901234567891", "1.1234567890123456789000", "1.5x", "", "18446744073709551616"};
+	const DecimalStatus parsed[] = {DecimalStatus::Ok, DecimalStatus::Inexact, DecimalStatus::Ok, DecimalStatus::Invalid, DecimalStatus::Invalid, DecimalStatus::Overflow};
+	for(size_t i = 0; i < 6; ++i)
+		assert(checked_from_chars(strings[i].data(), strings[i].data() + strings[i].size(), result) == parsed[i] && "checked_from_chars");
+	assert(checked_from_double(0.0009765625, result) == DecimalStatus::Ok && result == Decimal("0.0009765625") && "checked_from_double exact");
+	assert(checked_from_double(-0.1, result) == DecimalStatus::Inexact && result == Decimal("-0.1") && "checked_from_double inexact");
+	assert(checked_from_double(2e19, result) == DecimalStatus::Overflow && checked_from_double(std::numeric_limits<double>::quiet_NaN(), result) == DecimalStatus::Invalid && "checked_from_double errors");
+
+	// batches report the union of every element's status
+	std::vector<Decimal> a = {Decimal(1), max, Decimal(2)}, b = {Decimal(3), Decimal(1), Decimal(0)}, out(3);
+	clear_decimal_status();
+	assert(checked_add(a.data(), b.data(), a.size(), out.data()) == DecimalStatus::Overflow && out[0] == Decimal(4) && "batch checked_add");
+	assert(checked_sub(a.data(), b.data(), a.size(), out.data()) == DecimalStatus::Ok && out[2] == Decimal(2) && "batch checked_sub");
+	assert(checked_mul(a.data(), b.data(), a.size(), out.data()) == DecimalStatus::Ok && out[1] == max && "batch checked_mul");
+	assert(checked_div(a.data(), b.data(), a.size(), out.data()) == (DecimalStatus::DivisionByZero | DecimalStatus::Inexact) && out[2] == Decimal(0) && "batch checked_div");
+	assert(decimal_status() == (DecimalStatus::Overflow | DecimalStatus::DivisionByZero | DecimalStatus::Inexact) && "batch sticky flags");
+	clear_decimal_status();
+}
+
+void decimalColumnUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.5", "0.9999999999999999999", "-0.9999999999999999999", "0.0000000000000000001", "-0.0000000000000000001",
+		"12.75", "-12.75", "12.25", "-12.5", "18446744073709551615.9999999999999999999", "-18446744073709551615.9999999999999999999", "18446744073709551615", "-1.0000000000000000001"};
+	DecimalColumn a, b;
+	for(const char *l : values)
+	{
+		for(const char *r : values)
+		{
+			a.push_back(Decimal(l));
+			b.push_back(Decimal(r));
+		}
+	}
+	DEC_ASSERT( a[3], ==, Decimal("0") );
+
+	DecimalColumn out(a.size());
+	std::vector<int8_t> cmp(a.size());
+	SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512};
+	for(SimdLevel level : levels)
+	{
+		if(level > simdLevel())
+			continue;
+		tylawin::DataTypes::detail::add(level, a.view(), b.view(), false, out.out(), a.size());
+		for(size_t i = 0; i < a.size(); ++i)
+			assert(out[i] == a[i] + b[i] && "DecimalColumn add");
+		tylawin::DataTypes::detail::add(level, a.view(), b.view(), true, out.out(), a.size());
+		for(size_t i = 0; i < a.size(); ++i)
+			assert(out[i] == a[i] - b[i] && "DecimalColumn subtract");
+		tylawin::DataTypes::detail::compare(level, a.view(), b.view(), cmp.data(), a.size());
+		for(size_t i = 0; i < a.size(); ++i)
+			assert(cmp[i] == (a[i] < b[i] ? -1 : (a[i] > b[i] ? 1 : 0)) && "DecimalColumn compare");
+	}
+
+	negate(a, out);
+	for(size_t i = 0; i < a.size(); ++i)
+		assert(out[i] == -a[i] && "DecimalColumn negate");
+	DecimalColumn small(values, values + 13);
+	multiply(small, Decimal("-2.5"), out);
+	for(size_t i = 0; i < small.size(); ++i)
+		DEC_ASSERT( out[i], ==, small[i] * Decimal("-2.5") );
+	add(a, b, a);
+	DEC_ASSERT( a[1], ==, Decimal("1") );
+
+	bool threw = false;
+	try { add(a, small, out); } catch(const std::invalid_argument &) { threw = true; }
+	assert(threw && "DecimalColumn size mismatch");
+}
+
+void decimalPackedColumnUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// every delta width round trips through pack and each unpack kernel
+	std::vector<uint64_t> deltas(DecimalPackedColumn::BLOCK_SIZE), unpacked(deltas.size());
+	SimdLevel levels[] = {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512};
+	uint64_t seed = 1;
+	for(uint8_t bits = 0; bits <= 64; ++bits)
+	{
+		for(uint64_t &delta : deltas)
+		{
+			seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+			delta = bits == 0 ? 0 : seed >> (64 - bits);
+		}
+		std::vector<uint64_t> words(size_t(bits) * 8);
+		tylawin::DataTypes::detail::pack(deltas.data(), deltas.size(), bits, words.data());
+		for(SimdLevel level : levels)
+		{
+			if(level > simdLevel())
+				continue;
+			tylawin::DataTypes::detail::unpack(level, words.data(), bits, 5, unpacked.data());
+			for(size_t i = 0; i < deltas.size(); ++i)
+				assert(unpacked[i] == deltas[i] + 5 && "packed unpack");
+		}
+	}
+
+	// prices with 2 fraction digits in a narrow range, the last block partly filled
+	std::vector<Decimal> prices;
+	for(int i = 0; i < 1300; ++i)
+		prices.push_back(Decimal(10025 + (i * 7919) % 1000 - (i / 512) * 3000) / 100);
+	DecimalPackedColumn packed(prices.begin(), prices.end());
+	assert(packed.size() == prices.size() && packed.blockCount() == 3 && packed.blockSize(2) == 276 && packed.fractionDigits() == 2 && "packed shape");
+	assert(packed.memoryUsage() * 5 < prices.size() * sizeof(Decimal) && "packed memory");
+	std::vector<Decimal> decoded;
+	packed.decode(decoded);
+	std::vector<int64_t> scaled(DecimalPackedColumn::BLOCK_SIZE);
+	for(size_t block = 0; block < packed.blockCount(); ++block)
+	{
+		const size_t first = block * DecimalPackedColumn::BLOCK_SIZE, count = packed.decodeScaled(block, scaled.data());
+		assert(count == packed.blockSize(block) && "packed decodeScaled count");
+		DEC_ASSERT( packed.blockMin(block), ==, *std::min_element(prices.begin() + first, prices.begin() + first + count) );
+		DEC_ASSERT( packed.blockMax(block), ==, *std::max_element(prices.begin() + first, prices.begin() + first + count) );
+		for(size_t i = 0; i < count; ++i)
+			DEC_ASSERT( Decimal(scaled[i]) / 100, ==, prices[first + i] );
+	}
+	for(size_t i = 0; i < prices.size(); ++i)
+	{
+		DEC_ASSERT( packed[i], ==, prices[i] );
+		DEC_ASSERT( decoded[i], ==, prices[i] );
+	}
+
+	// a scan skips blocks by their max
+	const Decimal limit("75.5");
+	size_t above = 0, visited = 0;
+	std::vector<Decimal> block(DecimalPackedColumn::BLOCK_SIZE);
+	for(size_t b = 0; b < packed.blockCount(); ++b)
+	{
+		if(!(packed.blockMax(b) > limit))
+			continue;
+		++visited;
+		const size_t count = packed.decode(b, block.data());
+		above += size_t(std::count_if(block.begin(), block.begin() + count, [&](const Decimal &value) { return value > limit; }));
+	}
+	assert(visited == 2 && above == size_t(std::count_if(prices.begin(), prices.end(), [&](const Decimal &value) { return value > limit; })) && "packed scan");
+
+	// values past int64_t at 19 fraction digits keep their block as Decimals, equal values pack to 0 bits
+	DecimalColumn mixed;
+	const char *values[] = {"0", "-1", "0.0000000000000000001", "18446744073709551615.9999999999999999999", "-18446744073709551615.9999999999999999999", "-0.5"};
+	for(const char *str : values)
+		mixed.push_back(Decimal(str));
+	for(size_t i = 0; i < DecimalPackedColumn::BLOCK_SIZE; ++i)
+		mixed.push_back(Decimal("-0.3"));
+	DecimalPackedColumn wide(mixed);
+	assert(wide.fractionDigits() == 19 && !wide.scaledBlock(0) && wide.scaledBlock(1) && "packed raw block");
+	DEC_ASSERT( wide.blockMin(0), ==, Decimal(values[4]) );
+	DEC_ASSERT( wide.blockMax(0), ==, Decimal(values[3]) );
+	DEC_ASSERT( wide.blockMin(1), ==, Decimal("-0.3") );
+	for(size_t i = 0; i < mixed.size(); ++i)
+		DEC_ASSERT( wide[i], ==, mixed[i] );
+	assert(wide.decodeScaled(1, scaled.data()) == 6 && scaled[5] == -3000000000000000000LL && "packed negative scaled");
+	bool threw = false;
+	try { wide.decodeScaled(0, scaled.data()); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "packed raw decodeScaled");
+
+	DecimalPackedColumn empty(prices.begin(), prices.begin());
+	assert(empty.empty() && empty.blockCount() == 0 && "packed empty");
+}
+
+void decimalDivisorUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// whole, 64 bit scaled and 128 bit scaled divisors must all match operator/ exactly
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.0000001", "1.9999999999999999999", "-1.8446744073709551615", "1.8446744073709551616",
+		"5.55555555", "-6", "7", "3.3333", "123456789.987654321", "-98765.4321", "429496729.6000000001", "18446744073709551615.9999999999999999999"};
+	std::vector<Decimal> dividends;
+	for(const char *l : values)
+		dividends.push_back(Decimal(l));
+	std::vector<Decimal> quotients(dividends.size());
+	for(const char *r : values)
+	{
+		Decimal dr(r);
+		if(dr == Decimal(0))
+			continue;
+		DecimalDivisor divisor(dr);
+		divisor.divide(dividends.data(), dividends.size(), quotients.data());
+		for(size_t i = 0; i < dividends.size(); ++i)
+		{
+			DEC_ASSERT( divisor.divide(dividends[i]), ==, dividends[i] / dr );
+			DEC_ASSERT( quotients[i], ==, dividends[i] / dr );
+		}
+	}
+	for(uint64_t n : {1ULL, 3ULL, 7ULL, 10000000000000000000ULL, 18446744073709551615ULL})
+		for(const Decimal &value : dividends)
+			DEC_ASSERT( value / n, ==, value / Decimal(n) );
+	assert(to_string(Decimal("-0.0000000001") / uint64_t(100000000000ULL)) == "0" && "divide -0");
+
+	DecimalColumn column(dividends.begin(), dividends.end()), out;
+	divide(column, DecimalDivisor(Decimal("-3.5")), out);
+	for(size_t i = 0; i < column.size(); ++i)
+		DEC_ASSERT( out[i], ==, dividends[i] / Decimal("-3.5") );
+
+#ifdef DECIMAL_NATIVE_INT128
+	static_assert(DecimalDivisor(3_dec).divide(1_dec) == 0.3333333333333333333_dec && 7.5_dec / uint64_t(2) == 3.75_dec, "constexpr DecimalDivisor");
+#endif
+
+	bool threw = false;
+	try { DecimalDivisor divisor(Decimal(0)); } catch(const std::runtime_error &) { threw = true; }
+	assert(threw && "DecimalDivisor division by zero");
+	threw = false;
+	try { Decimal(1) / uint64_t(0); } catch(const std::runtime_error &) { threw = true; }
+	assert(threw && "uint64_t division by zero");
+}
+
+void decimalAccumulatorUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.0000001", "0.9999999999999999999", "-0.9999999999999999999", "123456789.987654321", "-98765.4321", "-7.25"};
+	DecimalAccumulator acc;
+	Decimal expected;
+	for(const char *v : values)
+	{
+		acc.add(Decimal(v));
+		expected += Decimal(v);
+	}
+	DEC_ASSERT( acc.result(), ==, expected );
+
+	std::vector<Decimal> many(1000, Decimal("0.9999999999999999999"));
+	DecimalAccumulator part1, part2;
+	part1.add(many.data(), many.size());
+	part2.add(many.begin(), many.end());
+	part2.add(Decimal("-0.0000000000000000001"));
+	part1.merge(part2);
+	DEC_ASSERT( part1.result(), ==, Decimal("1999.9999999999999997999") );
+
+	// intermediate totals past 2^64 are fine as long as the result fits
+	DecimalAccumulator wide;
+	Decimal max("18446744073709551615.9999999999999999999");
+	wide.add(max);
+	wide.add(max);
+	wide.add(-max);
+	DEC_ASSERT( wide.result(), ==, max );
+	wide.add(-max);
+	DEC_ASSERT( wide.result(), ==, Decimal(0) );
+	wide.add(Decimal("-3.5"));
+	wide.add(Decimal("3.5"));
+	assert(wide.result() == Decimal(0) && to_string(wide.result()) == "0" && "DecimalAccumulator -0");
+	wide.add(-max);
+	wide.add(-max);
+	bool threw = false;
+	try { wide.result(); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "DecimalAccumulator out_of_range");
+	wide.clear();
+	DEC_ASSERT( wide.result(), ==, Decimal(0) );
+}
+
+void decimalGroupByUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	std::hash<Decimal> hasher;
+	assert(hasher(Decimal("-0")) == hasher(Decimal(0)) && hasher(Decimal("1.5")) == hasher(Decimal(1.5)) && "equal values hash equal");
+	std::unordered_set<size_t> hashes, lowBits;
+	for(int i = 0; i < 10000; ++i)
+	{
+		Decimal price = Decimal("100") + Decimal(i) / 100;
+		hashes.insert(hasher(price));
+		hashes.insert(hasher(-price));
+		lowBits.insert(hasher(price) & 0x3FFF);
+	}
+	assert(hashes.size() == 20000 && lowBits.size() > 7000 && "price levels hash apart");
+
+	std::unordered_map<Decimal, int> levels;
+	levels[Decimal("10.25")] += 2;
+	levels[Decimal("10.250")] += 3;
+	levels[Decimal("-10.25")] += 1;
+	assert(levels.size() == 2 && levels[Decimal("10.25")] == 5 && "unordered_map keyed by Decimal");
+	std::unordered_set<Decimal64> compact = {Decimal64("1.5"), Decimal64("1.50"), Decimal64("-1.5")};
+	assert(compact.size() == 2 && "unordered_set of Decimal64");
+
+	// volume weighted average price from per price level volume
+	const char *trades[][2] = {{"10.25", "100"}, {"10.5", "50"}, {"10.25", "25"}, {"0", "1"}, {"-0", "2"}, {"10.5", "-10"}};
+	DecimalGroupBy byPrice;
+	for(auto &trade : trades)
+		byPrice.add(Decimal(trade[0]), Decimal(trade[1]));
+	assert(byPrice.size() == 3 && "group count");
+	const DecimalGroupBy::Group *level = byPrice.find(Decimal("10.25"));
+	assert(level != nullptr && level->count == 2 && "group found");
+	DEC_ASSERT( level->sum.result(), ==, Decimal(125) );
+	DEC_ASSERT( byPrice.find(Decimal("10.5"))->sum.result(), ==, Decimal(40) );
+	assert(byPrice.find(Decimal(0))->count == 2 && byPrice.find(Decimal("10.75")) == nullptr && "zero group and missing key");
+	Decimal notional, volume;
+	for(const DecimalGroupBy::Group &group : byPrice)
+	{
+		notional += group.key * group.sum.result();
+		volume += group.sum.result();
+	}
+	DEC_ASSERT( notional / volume, ==, Decimal("10.126488095238095238") );
+	assert(byPrice.begin()->key == Decimal("10.25") && "groups keep first seen order");
+
+	// growth, batches and merging partial tables
+	std::vector<Decimal> keys, values;
+	for(int i = 0; i < 5000; ++i)
+	{
+		keys.push_back(Decimal(i % 1000) / 8);
+		values.push_back(Decimal(i) / 1000);
+	}
+	DecimalGroupBy first, second(1000);
+	first.add(keys.data(), values.data(), 2500);
+	second.add(keys.data() + 2500, values.data() + 2500, 2500);
+	first.merge(second);
+	assert(first.size() == 1000 && "merged group count");
+	for(int k = 0; k < 1000; ++k)
+	{
+		const DecimalGroupBy::Group *group = first.find(Decimal(k) / 8);
+		assert(group != nullptr && group->count == 5 && "merged group");
+		DEC_ASSERT( group->sum.result(), ==, Decimal(5 * k + 10000) / 1000 );
+	}
+	first.clear();
+	assert(first.empty() && first.find(Decimal(0)) == nullptr && "cleared");
+	first.add(Decimal(1), Decimal(1));
+	assert(first.size() == 1 && first.find(Decimal(1))->count == 1 && "reuse after clear");
+}
+
+void decimalSortUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// sort keys keep order within CompactDecimal's range
+	const char *ordered[] = {"-17014118346046923173.1687303715884105728", "-12.5", "-0.0000000000000000001", "0", "0.0000000000000000001",
+		"0.5", "12.5", "17014118346046923173.1687303715884105727"};
+	for(size_t i = 1; i < sizeof(ordered) / sizeof(ordered[0]); ++i)
+		assert(sort_key(Decimal(ordered[i - 1])) < sort_key(Decimal(ordered[i])) && "sort key order");
+	assert(sort_key(Decimal("-0")) == sort_key(Decimal(0)) && "sort key of -0");
+	bool threw = false;
+	try { sort_key(Decimal("17014118346046923173.1687303715884105728")); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "sort key range");
+	assert(sort_key(Decimal64("-0.00000001")) < sort_key(Decimal64(0)) && sort_key(Decimal64(0)) < sort_key(Decimal64("92233720368.54775807")) && "Decimal64 sort key");
+
+	// radix sort and partial sort against std::sort, including the full Decimal range
+	std::vector<Decimal> values;
+	uint64_t state = 88172645463325252ULL;
+	for(int i = 0; i < 20000; ++i)
+	{
+		state ^= state << 13;
+		state ^= state >> 7;
+		state ^= state << 17;
+		Decimal value = i % 3 == 0 ? Decimal(static_cast<int64_t>(state % 200000)) / 100 : Decimal(std::to_string(state >> (state & 63)) + "." + std::to_string(state % 10000000));
+		values.push_back(state & 1 ? -value : value);
+	}
+	values.push_back(Decimal("18446744073709551615.9999999999999999999"));
+	values.push_back(Decimal("-18446744073709551615.9999999999999999999"));
+	for(size_t count : {size_t(0), size_t(1), size_t(100), values.size()})
+	{
+		std::vector<Decimal> expected(values.begin(), values.begin() + count), sorted(expected);
+		std::sort(expected.begin(), expected.end());
+		radix_sort(sorted.data(), sorted.data() + count);
+		assert(sorted == expected && "radix sort ascending");
+		sorted.assign(values.begin(), values.begin() + count);
+		radix_sort(sorted.data(), sorted.data() + count, SortOrder::Descending);
+		assert(std::equal(sorted.begin(), sorted.end(), expected.rbegin()) && "radix sort descending");
+
+		for(size_t k : {size_t(0), count / 200, count / 2, count})
+		{
+			sorted.assign(values.begin(), values.begin() + count);
+			partial_sort(sorted.data(), sorted.data() + k, sorted.data() + count);
+			assert(std::equal(sorted.begin(), sorted.begin() + k, expected.begin()) && "partial sort smallest");
+			sorted.assign(values.begin(), values.begin() + count);
+			partial_sort(sorted.data(), sorted.data() + k, sorted.data() + count, SortOrder::Descending);
+			assert(std::equal(sorted.begin(), sorted.begin() + k, expected.rbegin()) && "partial sort largest");
+		}
+	}
+}
+
+void decimalInstrumentationUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	reset_decimal_counters();
+	Decimal one(1), two(2), half("0.5");
+	Decimal sum = one + two;
+	Decimal difference = one - two;
+	Decimal product = two * half;
+	Decimal quotient = one / Decimal(5);
+	quotient = quotient / 4;
+	bool less = one < two;
+	std::string str = to_string(half, 30);
+	bool threw = false;
+	try { quotient = one / Decimal(0); } catch(const std::runtime_error &) { threw = true; }
+	assert(threw && less && sum != difference && product != quotient && "instrumented operations");
+
+	std::thread worker([]() {
+		Decimal total;
+		for(int i = 0; i < 1000; ++i)
+			total += Decimal(i);
+	});
+	worker.join();
+
+	DecimalCounters counters = decimal_counters();
+	std::ostringstream text, json;
+	write_decimal_counters(text, counters);
+	write_decimal_counters(json, counters, CounterFormat::Json);
+#ifdef DECIMAL_INSTRUMENTATION
+	assert(counters[DecimalCounter::Parse] == 1 && counters[DecimalCounter::Multiply] == 1 && "parse and multiply counts");
+	assert(counters[DecimalCounter::Add] == 1001 && counters[DecimalCounter::Divide] == 3 && "add and divide counts");
+	assert(counters[DecimalCounter::Format] == 1 && counters[DecimalCounter::FormatAllocation] == 1 && counters[DecimalCounter::Exception] == 1 && "format and exception counts");
+#ifdef DECIMAL_EXPRESSION_TEMPLATES
+	// expressions are evaluated exactly, without the eager operators' slow paths
+	assert(counters[DecimalCounter::Subtract] == 1 && counters[DecimalCounter::AddSubtractSlowPath] == 0 && counters[DecimalCounter::WideDivide] == 0 && "expression counts");
+#else
+	assert(counters[DecimalCounter::Subtract] == 2 && counters[DecimalCounter::AddSubtractSlowPath] == 1 && counters[DecimalCounter::WideDivide] == 1 && "operator counts");
+	assert(text.str().find("add_subtract_slow_path  1\n") != std::string::npos && "slow path dump");
+#endif
+	const uint64_t threadAdds = thread_decimal_counters()[DecimalCounter::Add];
+	sum += one;
+	assert(thread_decimal_counters()[DecimalCounter::Add] == threadAdds + 1 && "thread counts");
+	assert(text.str().find("add                     1001\n") != std::string::npos && json.str().find("\"add\": 1001, ") != std::string::npos && "counter dump");
+	reset_decimal_counters();
+	assert(decimal_counters()[DecimalCounter::Add] == 0 && "reset counters");
+	DecimalColumn column(2), shorter(1);
+	try { add(column, shorter, column); } catch(const std::invalid_argument &) { }
+	assert(decimal_counters()[DecimalCounter::Exception] == 1 && "exceptions from the other headers");
+#else
+	for(uint64_t count : counters.counts)
+		assert(count == 0 && "counters are compiled out");
+	assert(json.str().find("\"exception\": 0}") != std::string::npos && "counter dump");
+#endif
+}
+
+void decimalParallelUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	std::vector<Decimal> a, b;
+	for(int i = 0; i < 10007; ++i)
+	{
+		a.push_back(Decimal(i % 7 == 0 ? -i : i) / Decimal(3));
+		b.push_back(Decimal("0.3333333333333333333") * Decimal(i % 11));
+	}
+	DecimalAccumulator sum, dot;
+	for(size_t i = 0; i < a.size(); ++i)
+	{
+		sum.add(a[i]);
+		dot.add(a[i] * b[i]);
+	}
+
+	for(size_t threads : {1, 2, 3, 8})
+	{
+		ThreadPool pool(threads);
+		DEC_ASSERT( parallel_sum(a.begin(), a.end(), pool), ==, sum.result() );
+		DEC_ASSERT( parallel_dot(a.begin(), a.end(), b.begin(), pool), ==, dot.result() );
+		DEC_ASSERT( parallel_sum(a.begin(), a.begin(), pool), ==, Decimal(0) );
+
+		std::vector<Decimal> out(a.size());
+		parallel_transform(a.begin(), a.end(), out.begin(), [](const Decimal &d) { return -d * Decimal(2); }, pool);
+		for(size_t i = 0; i < a.size(); ++i)
+			DEC_ASSERT( out[i], ==, -a[i] * Decimal(2) );
+
+		bool threw = false;
+		try { parallel_transform(b.begin(), b.end(), out.begin(), [](const Decimal &d) { return Decimal(1) / d; }, pool); } catch(const std::runtime_error &) { threw = true; }
+		assert(threw && "parallel_transform rethrows");
+	}
+	DEC_ASSERT( parallel_sum(a.begin(), a.end()), ==, sum.result() );
+}
+
+void decimalCsvUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	std::string text = "name,price,qty\r\n";
+	std::vector<std::string> prices, qtys;
+	std::vector<size_t> badOffsets;
+	for(int i = 0; i < 20000; ++i)
+	{
+		std::string price = std::to_string(i * 7919 % 100003) + "." + std::to_string(i % 1000);
+		std::string qty = i % 3 == 0 ? "-" + std::to_string(i) : (i % 5 == 0 ? "" : "0.0000000000000000001");
+		if(i % 997 == 0)
+		{
+			badOffsets.push_back(text.size() + 4);
+			text += "row,1.2.3," + qty + "\n";
+			continue;
+		}
+		prices.push_back(price);
+		qtys.push_back(qty);
+		text += "row," + price + "," + qty + (i % 2 ? "\n" : "\r\n");
+		if(i % 1001 == 0)
+			text += "\n";
+	}
+	text += "row,5,";
+
+	CsvOptions options;
+	options.hasHeader = true;
+	options.columns = {2, 1};
+	for(size_t threads : {1, 3})
+	{
+		ThreadPool pool(threads);
+		CsvResult res = parse_csv(text.data(), text.data() + text.size(), options, pool);
+		assert(res.columns.size() == 2 && res.columns[0].size() == prices.size() + 1 && res.rows == 20001 && "parse_csv rows");
+		for(size_t i = 0; i < prices.size(); ++i)
+		{
+			DEC_ASSERT( res.columns[1][i], ==, Decimal(prices[i]) );
+			DEC_ASSERT( res.columns[0][i], ==, Decimal(qtys[i]) );
+		}
+		DEC_ASSERT( res.columns[0][prices.size()], ==, Decimal(0) );
+		assert(res.errors.size() == badOffsets.size() && "parse_csv errors");
+		for(size_t i = 0; i < badOffsets.size(); ++i)
+			assert(res.errors[i].offset == badOffsets[i] && res.errors[i].row == i * 997 && res.errors[i].column == 1 && res.errors[i].ec == std::errc::invalid_argument && "parse_csv error offset");
+	}
+
+	const char small[] = "1;-2.5\n3\n99999999999999999999;1\n";
+	options = CsvOptions();
+	options.delimiter = ';';
+	CsvResult res = parse_csv(small, small + sizeof(small) - 1, options);
+	assert(res.columns.size() == 2 && res.columns[1].size() == 1 && res.errors.size() == 2 && "parse_csv missing field");
+	DEC_ASSERT( res.columns[1][0], ==, Decimal("-2.5") );
+	assert(res.errors[0].offset == 8 && res.errors[0].column == 1 && res.errors[1].ec == std::errc::result_out_of_range && "parse_csv error kinds");
+
+	// a field listed twice fills both columns
+	options.columns = {1, 0, 1};
+	res = parse_csv(small, small + sizeof(small) - 1, options);
+	assert(res.columns.size() == 3 && res.columns[0].size() == 1 && res.columns[2].size() == 1 && res.errors.size() == 2 && "parse_csv duplicate field");
+	DEC_ASSERT( res.columns[0][0], ==, Decimal("-2.5") );
+	DEC_ASSERT( res.columns[2][0], ==, Decimal("-2.5") );
+	DEC_ASSERT( res.columns[1][0], ==, Decimal(1) );
+	options.columns.clear();
+
+	const char *path = "runTestsCsv.tmp";
+	{
+		std::ofstream out(path, std::ios::binary);
+		out << small;
+	}
+	res = load_csv(path, options);
+	std::remove(path);
+	assert(res.columns[0].size() == 1 && res.errors.size() == 2 && "load_csv");
+	DEC_ASSERT( res.columns[0][0], ==, Decimal(1) );
+
+	bool threw = false;
+	try { load_csv(path); } catch(const std::runtime_error &) { threw = true; }
+	assert(threw && "load_csv missing file");
+}
+
+void decimalBinaryUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	const char *values[] = {"0", "1", "-1", "12.5", "-0.0000000000000000001", "0.1", "123456789.987654321", "-98765.4321",
+		"18446744073709551615.9999999999999999999", "-18446744073709551615.9999999999999999999", "127", "128.0000000000000000001"};
+	std::vector<Decimal> decimals;
+	for(const char *v : values)
+		decimals.push_back(Decimal(v));
+
+	{
+		char buf[FIXED_ENCODED_SIZE];
+		encode_fixed(Decimal("-1.5"), buf);
+		const unsigned char expected[FIXED_ENCODED_SIZE] = {1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xf4, 0x44, 0x82, 0x91, 0x63, 0x45, 1};
+		assert(memcmp(buf, expected, sizeof(buf)) == 0 && "encode_fixed layout");
+		char small[VARINT_MAX_ENCODED_SIZE];
+		assert(encode_varint(Decimal(0), small) == small + 2 && encode_varint(Decimal("12.5"), small) == small + 3 && "encode_varint size");
+		assert(small[0] == 2 && small[1] == 12 && small[2] == 5 && "encode_varint layout");
+	}
+
+	std::vector<char> fixed(decimals.size() * FIXED_ENCODED_SIZE), varint(decimals.size() * VARINT_MAX_ENCODED_SIZE);
+	assert(encode_fixed(decimals.data(), decimals.size(), fixed.data()) == fixed.data() + fixed.size() && "encode_fixed batch");
+	char *varintEnd = encode_varint(decimals.data(), decimals.size(), varint.data());
+	std::vector<Decimal> decoded(decimals.size());
+	from_chars_result res = decode_fixed(fixed.data(), fixed.data() + fixed.size(), decoded.data(), decoded.size());
+	assert(res.ec == std::errc() && res.ptr == fixed.data() + fixed.size() && decoded == decimals && "decode_fixed batch");
+	std::fill(decoded.begin(), decoded.end(), Decimal());
+	res = decode_varint(varint.data(), varintEnd, decoded.data(), decoded.size());
+	assert(res.ec == std::errc() && res.ptr == varintEnd && decoded == decimals && "decode_varint batch");
+
+	DecimalSpanView view(fixed.data(), fixed.size());
+	assert(view.size() == decimals.size() && view.validate() == view.size() && std::equal(view.begin(), view.end(), decimals.begin()) && "DecimalSpanView");
+	DEC_ASSERT( view.at(3), ==, Decimal("12.5") );
+	DEC_ASSERT( view.subspan(2, 3)[1], ==, Decimal("12.5") );
+	assert(view.end() - view.begin() == ptrdiff_t(view.size()) && view.begin()[4] == decimals[4] && "DecimalSpanView iterator");
+
+	fixed[3 * FIXED_ENCODED_SIZE + 15] = char(0xff);
+	assert(view.validate() == 3 && "DecimalSpanView validate");
+	bool threw = false;
+	try { view.at(3); } catch(const std::invalid_argument &) { threw = true; }
+	assert(threw && "DecimalSpanView corrupt");
+	res = decode_fixed(fixed.data(), fixed.data() + fixed.size(), decoded.data(), decoded.size());
+	assert(res.ec == std::errc::invalid_argument && res.ptr == fixed.data() + 3 * FIXED_ENCODED_SIZE && "decode_fixed corrupt");
+	threw = false;
+	try { DecimalSpanView bad(fixed.data(), 5); } catch(const std::invalid_argument &) { threw = true; }
+	assert(threw && "DecimalSpanView size");
+
+	Decimal d;
+	res = decode_varint(varint.data(), varint.data() + 2, d);
+	assert(res.ec == std::errc() && d == Decimal(0) && "decode_varint zero");
+	res = decode_varint(varint.data() + 6, varint.data() + 8, d);
+	assert(res.ec == std::errc::invalid_argument && "decode_varint truncated");
+	const char overflow[] = "\x00\xff\xff\xff\xff\xff\xff\xff\xff\xff\x02";
+	res = decode_varint(overflow, overflow + sizeof(overflow) - 1, d);
+	assert(res.ec == std::errc::result_out_of_range && "decode_varint overflow");
+	const char zeroFraction[] = {2, 1, 10};
+	res = decode_varint(zeroFraction, zeroFraction + 3, d);
+	assert(res.ec == std::errc::invalid_argument && "decode_varint fraction");
+	const char overlong[] = {0, char(0x85), char(0x80), 0};
+	res = decode_varint(overlong, overlong + 4, d);
+	assert(res.ec == std::errc::invalid_argument && "decode_varint overlong");
+}
+
+void decimalDotUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.0000001", "1.9999999999999999999", "-1.9999999999999999999", "5.55555555", "-6",
+		"7.5555", "3.3333", "123456789.987654321", "-98765.4321", "429496729.5000000001", "-0.0000000000000000001", "0.9999999999999999999"};
+	std::vector<Decimal> a, b;
+	for(const char *l : values)
+	{
+		for(const char *r : values)
+		{
+			a.push_back(Decimal(l));
+			b.push_back(Decimal(r));
+		}
+	}
+	// every product above with at most 19 fraction digits is exact, the sum of the truncated products is the reference
+	std::vector<Decimal> exactA, exactB;
+	Decimal expected;
+	for(size_t i = 0; i < a.size(); ++i)
+	{
+		Decimal product = a[i] * b[i];
+		if(to_string(a[i]).size() + to_string(b[i]).size() < 24)
+		{
+			exactA.push_back(a[i]);
+			exactB.push_back(b[i]);
+			expected += product;
+		}
+	}
+	DEC_ASSERT( dot(exactA.data(), exactA.data() + exactA.size(), exactB.data()), ==, expected );
+	DEC_ASSERT( dot(exactA.begin(), exactA.end(), exactB.begin()), ==, expected );
+
+	// the column path (SIMD when available) must agree with the scalar path on every rounding mode
+	DecimalColumn columnA(a.begin(), a.end()), columnB(b.begin(), b.end());
+	RoundingMode modes[] = {RoundingMode::Truncate, RoundingMode::HalfUp, RoundingMode::HalfEven, RoundingMode::Floor, RoundingMode::Ceiling};
+	for(RoundingMode mode : modes)
+		DEC_ASSERT( dot(columnA, columnB, mode), ==, dot(a.begin(), a.end(), b.begin(), mode) );
+
+	std::vector<Decimal> tiny(10, Decimal("0.0000000001"));
+	DEC_ASSERT( dot(tiny.begin(), tiny.end(), tiny.begin()), ==, Decimal("0.0000000000000000001") );
+	DEC_ASSERT( fma(Decimal("0.0000000001"), Decimal("0.0000000005"), Decimal(0)), ==, Decimal(0) );
+	DEC_ASSERT( fma(Decimal("0.0000000001"), Decimal("0.0000000005"), Decimal(0), RoundingMode::HalfUp), ==, Decimal("0.0000000000000000001") );
+	DEC_ASSERT( fma(Decimal("0.0000000001"), Decimal("0.0000000005"), Decimal(0), RoundingMode::HalfEven), ==, Decimal(0) );
+	DEC_ASSERT( fma(Decimal("-0.0000000001"), Decimal("0.0000000001"), Decimal(1), RoundingMode::Truncate), ==, Decimal("0.9999999999999999999") );
+	DEC_ASSERT( fma(Decimal("-0.0000000001"), Decimal("0.0000000001"), Decimal(1), RoundingMode::Ceiling), ==, Decimal(1) );
+	DEC_ASSERT( fma(Decimal("0.0000000001"), Decimal("0.0000000001"), Decimal(-1), RoundingMode::Floor), ==, Decimal(-1) );
+	DEC_ASSERT( fma(Decimal("0.0000000001"), Decimal("0.0000000001"), Decimal(-1)), ==, Decimal("-0.9999999999999999999") );
+	DEC_ASSERT( fma(Decimal(-3), Decimal(2), Decimal(6)), ==, Decimal(0) );
+	assert(to_string(fma(Decimal(-3), Decimal(2), Decimal(6))) == "0" && "fma -0");
+
+	// totals past the Decimal range in between are fine
+	Decimal big("4294967296");
+	DecimalDotAccumulator acc;
+	acc.add(big, big);
+	acc.add(big, -big);
+	acc.add(Decimal("2.5"));
+	DEC_ASSERT( acc.result(), ==, Decimal("2.5") );
+	acc.add(big, big);
+	bool threw = false;
+	try { acc.result(); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "DecimalDotAccumulator out_of_range");
+}
+
+void decimalExpressionUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// single operations match the operators exactly, including truncation and whole part wrap around
+	const char *values[] = {"0", "1", "-1", "0.5", "-0.0000001", "1.9999999999999999999", "-1.8446744073709551615", "3.3333",
+		"123456789.987654321", "-98765.4321", "429496729.6000000001", "18446744073709551615.9999999999999999999"};
+	for(const char *l : values)
+	{
+		for(const char *r : values)
+		{
+			Decimal dl(l), dr(r), expected(dl);
+			expected += dr;
+			DEC_ASSERT( Decimal(lazy(dl) + dr), ==, expected );
+			expected = dl;
+			expected -= dr;
+			DEC_ASSERT( Decimal(lazy(dl) - dr), ==, expected );
+			expected = dl;
+			expected *= dr;
+			DEC_ASSERT( Decimal(lazy(dl) * dr), ==, expected );
+			if(dr != Decimal(0))
+			{
+				expected = dl;
+				expected /= dr;
+				DEC_ASSERT( Decimal(lazy(dl) / dr), ==, expected );
+			}
+		}
+	}
+
+	// compound expressions round once at the end
+	Decimal tiny("0.0000000001"), half("0.0000000005"), price("19.99"), qty("3.5"), fee("0.25"), rebate("0.0375");
+	DEC_ASSERT( Decimal(lazy(price) * qty + fee - rebate), ==, Decimal("70.1775") );
+	DEC_ASSERT( Decimal(lazy(tiny) * half + lazy(tiny) * half), ==, Decimal("0.0000000000000000001") );
+	DEC_ASSERT( Decimal(lazy(Decimal(1)) / 3 * 3), ==, Decimal(1) );
+	DEC_ASSERT( Decimal(lazy(Decimal(2)) / 3 + lazy(Decimal(1)) / 3), ==, Decimal(1) );
+	DEC_ASSERT( Decimal((lazy(price) - fee) * (lazy(qty) + 1) / 4), ==, Decimal("22.2075") );
+	DEC_ASSERT( lazy(tiny) * half, ==, Decimal(0) );
+	DEC_ASSERT( (lazy(tiny) * half).evaluate(RoundingMode::HalfUp), ==, Decimal("0.0000000000000000001") );
+	DEC_ASSERT( (lazy(tiny) * half).evaluate(RoundingMode::HalfEven), ==, Decimal(0) );
+	DEC_ASSERT( (lazy(-tiny) * half).evaluate(RoundingMode::Floor), ==, Decimal("-0.0000000000000000001") );
+	DEC_ASSERT( (lazy(Decimal(2)) / 3).evaluate(RoundingMode::HalfUp), ==, Decimal("0.6666666666666666667") );
+	DEC_ASSERT( -(lazy(price) * 2), ==, Decimal("-39.98") );
+	assert(to_string(lazy(Decimal(-3)) * 2 + 6) == "0" && "expression -0");
+	assert(lazy(price) * qty > Decimal(69) && Decimal(70) > lazy(price) * qty && lazy(price) != price * 2 && "expression compare");
+
+	// operands are stored by value so an expression can outlive them
+	auto total = lazy(price) * qty;
+	price = Decimal(0);
+	DEC_ASSERT( Decimal(total), ==, Decimal("69.965") );
+
+	// templates deducing BasicDecimal take the evaluated expression
+	DEC_ASSERT( Decimal(decimal_cast<Decimal64>(total / 7, RoundingMode::HalfUp)), ==, Decimal("9.995") );
+	DEC_ASSERT( Decimal(Decimal64(lazy(qty) / 3)), ==, Decimal("1.16666666") );
+	assert(sort_key(total) == sort_key(Decimal("69.965")) && "expression sort_key");
+#ifdef DECIMAL_NATIVE_INT128
+	static_assert(lazy(1.5_dec) * 3 + 1 == 5.5_dec && (lazy(2_dec) / 3).evaluate(RoundingMode::HalfUp) == 0.6666666666666666667_dec, "constexpr expressions");
+#endif
+
+	bool threw = false;
+	try { (void)Decimal(lazy(fee) / (lazy(qty) - qty)); } catch(const std::runtime_error &) { threw = true; }
+	assert(threw && "expression division by zero");
+}
+
+void decimalMathUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// pow is exact when the result fits in 19 fraction digits
+	DEC_ASSERT( pow(Decimal("1.1"), 10), ==, Decimal("2.5937424601") );
+	DEC_ASSERT( pow(Decimal(-2), 63), ==, Decimal("-9223372036854775808") );
+	DEC_ASSERT( pow(Decimal("0.2"), -3), ==, Decimal(125) );
+	DEC_ASSERT( pow(Decimal("-0.5"), -11), ==, Decimal(-2048) );
+	DEC_ASSERT( pow(Decimal("123.45"), 0), ==, Decimal(1) );
+	DEC_ASSERT( pow(Decimal(0), 0), ==, Decimal(1) );
+	DEC_ASSERT( pow(Decimal(1), -1000000000000LL), ==, Decimal(1) );
+	DEC_ASSERT( pow(Decimal(3), -1), ==, Decimal("0.3333333333333333333") );
+	DEC_ASSERT( pow(Decimal(-3), -1, RoundingMode::Floor), ==, Decimal("-0.3333333333333333334") );
+	DEC_ASSERT( pow(Decimal("1.0000001"), 1000000), ==, Decimal("1.1051709125497934166") );
+	DEC_ASSERT( pow(Decimal("1.0005"), -360), ==, Decimal("0.8353077868915891337") );
+
+	// sqrt is correctly rounded in every mode
+	DEC_ASSERT( sqrt(Decimal(2)), ==, Decimal("1.4142135623730950488") );
+	DEC_ASSERT( sqrt(Decimal("6.25")), ==, Decimal("2.5") );
+	DEC_ASSERT( sqrt(Decimal("0.0000000000000000001")), ==, Decimal("0.000000000316227766") );
+	DEC_ASSERT( sqrt(Decimal("0.0000000000000000001"), RoundingMode::Ceiling), ==, Decimal("0.0000000003162277661") );
+	DEC_ASSERT( sqrt(Decimal("18446744073709551615.9999999999999999999")), ==, Decimal("4294967295.9999999999999999999") );
+	DEC_ASSERT( sqrt(Decimal("18446744073709551615.9999999999999999999"), RoundingMode::HalfUp), ==, Decimal(4294967296) );
+	DEC_ASSERT( sqrt(Decimal(0)), ==, Decimal(0) );
+
+	// exp and log against values computed to 80 digits
+	DEC_ASSERT( exp(Decimal(0)), ==, Decimal(1) );
+	DEC_ASSERT( exp(Decimal(1)), ==, Decimal("2.7182818284590452353") );
+	DEC_ASSERT( exp(Decimal(1), RoundingMode::HalfEven), ==, Decimal("2.7182818284590452354") );
+	DEC_ASSERT( exp(Decimal(-1)), ==, Decimal("0.3678794411714423215") );
+	DEC_ASSERT( exp(Decimal("44.3614")), ==, Decimal("18446383335725770459.0376374372855714375") );
+	DEC_ASSERT( exp(Decimal("-43.5")), ==, Decimal("0.0000000000000000001") );
+	DEC_ASSERT( exp(Decimal(-100)), ==, Decimal(0) );
+	DEC_ASSERT( exp(Decimal(-100), RoundingMode::Ceiling), ==, Decimal("0.0000000000000000001") );
+	DEC_ASSERT( log(Decimal(1)), ==, Decimal(0) );
+	DEC_ASSERT( log(Decimal(2)), ==, Decimal("0.6931471805599453094") );
+	DEC_ASSERT( log(Decimal(10)), ==, Decimal("2.302585092994045684") );
+	DEC_ASSERT( log(Decimal("0.05")), ==, Decimal("-2.9957322735539909934") );
+	DEC_ASSERT( log(Decimal("0.0000000000000000001")), ==, Decimal("-43.7491167668868679963") );
+	DEC_ASSERT( log(Decimal("18446744073709551615.9999999999999999999")), ==, Decimal("44.3614195558364998027") );
+	for(int i = 1; i <= 1000; ++i)
+	{
+		// log(x) rounded to 10^-19 moves exp(log(x)) by about x * 10^-19
+		Decimal x = Decimal(i) / 7, back = exp(log(x), RoundingMode::HalfEven) - x, tolerance = x * Decimal("0.0000000000000000002") + Decimal("0.0000000000000000001");
+		assert(back <= tolerance && -back <= tolerance && "exp(log(x))");
+	}
+
+	bool threw = false;
+	try { pow(Decimal(2), 64); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "pow overflow");
+	threw = false;
+	try { pow(Decimal("0.3"), -41); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "pow negative exponent overflow");
+	threw = false;
+	try { pow(Decimal(0), -1); } catch(const std::runtime_error &) { threw = true; }
+	assert(threw && "pow division by zero");
+	threw = false;
+	try { exp(Decimal("44.37")); } catch(const std::out_of_range &) { threw = true; }
+	assert(threw && "exp overflow");
+	threw = false;
+	try { sqrt(Decimal("-0.0000000000000000001")); } catch(const std::invalid_argument &) { threw = true; }
+	assert(threw && "sqrt of a negative value");
+	threw = false;
+	try { log(Decimal(0)); } catch(const std::invalid_argument &) { threw = true; }
+	assert(threw && "log of 0");
 }
 
 int main(int argc, char **argv)
@@ -230,6 +1386,27 @@ int main(int argc, char **argv)
 	try
 	{
 		decimalUnitTests();
+		decimalSecondUnitTests();
+		decimal64UnitTests();
+		decimalDivisorUnitTests();
+		decimalQuantizeUnitTests();
+		decimalMixedIntegerUnitTests();
+		decimalCheckedUnitTests();
+		decimalAccumulatorUnitTests();
+		decimalGroupByUnitTests();
+		decimalSortUnitTests();
+		decimalMathUnitTests();
+		decimalInstrumentationUnitTests();
+		decimalBinaryUnitTests();
+		decimalColumnUnitTests();
+		decimalPackedColumnUnitTests();
+		decimalParallelUnitTests();
+		decimalCsvUnitTests();
+		decimalDotUnitTests();
+		decimalExpressionUnitTests();
+#ifdef DECIMAL_NATIVE_INT128
+		compactDecimalUnitTests();
+#endif
 	}
 	catch(const std::exception &e)
 	{
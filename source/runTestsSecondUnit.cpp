@@ -0,0 +1,45 @@
+/*
+Copyright 2016 Tyler Winters
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+// Linked into the test programs next to runTests.cpp so every header is included from two translation units.
+
+#include "../include/Decimal.hpp"
+#include "../include/DecimalAccumulator.hpp"
+#include "../include/DecimalBinary.hpp"
+#include "../include/DecimalChecked.hpp"
+#include "../include/DecimalColumn.hpp"
+#include "../include/DecimalCsv.hpp"
+#include "../include/DecimalDot.hpp"
+#include "../include/DecimalExpression.hpp"
+#include "../include/DecimalGroupBy.hpp"
+#include "../include/DecimalInstrumentation.hpp"
+#include "../include/DecimalMath.hpp"
+#include "../include/DecimalPackedColumn.hpp"
+#include "../include/DecimalParallel.hpp"
+#include "../include/DecimalSort.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+void decimalSecondUnitTests()
+{
+	using namespace tylawin::DataTypes;
+
+	// the constants are odr-used here and in runTests.cpp
+	const uint16_t &digits = Decimal::FRACTION_DIGITS;
+	assert(std::min(Decimal::MAX_STRING_LENGTH, size_t(64)) == 41 && digits == 19 && "second unit constants");
+	assert(to_string(Decimal("1.5") / -3) == "-0.5" && to_string(Decimal(1) / Decimal(8)) == "0.125" && "second unit arithmetic");
+}